@@ -0,0 +1,277 @@
+#ifndef FCPP_ALLOCATOR_H
+#define FCPP_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+namespace fcpp
+{
+
+// ////////////////////////////////////////////////////////////////////////
+// allocators for list nodes (e.g. List<T, pool_allocator<T>>)
+//
+//  Nodes carry their reference count, so a single allocation holds the
+//  whole node; these allocators only ever see requests for one object of a
+//  (rebound) node type.
+// ////////////////////////////////////////////////////////////////////////
+
+
+
+// bump allocator that hands out memory from large blocks and frees them
+//  only all at once (when the arena is destroyed)
+//
+//  Not thread safe: a list allocated in an arena should be built, forced
+//  and released on one thread, and must not outlive the arena. While an
+//  arena is alive it is also the current arena of the thread that created
+//  it (arenas stack, so destroy them in reverse order of creation).
+struct monotonic_arena {
+  explicit monotonic_arena (std::size_t block_size = 1 << 20) :
+    _block_size(block_size), _previous(current_slot())
+  {
+    current_slot() = this;
+  }
+  monotonic_arena (const monotonic_arena&) = delete;
+  monotonic_arena& operator= (const monotonic_arena&) = delete;
+  ~monotonic_arena ()
+  {
+    current_slot() = _previous;
+    _free_blocks(nullptr);
+  }
+
+  void* allocate (std::size_t bytes, std::size_t align)
+  {
+    auto p = _align_up(_next, align);
+    if (!_blocks || p + bytes > _end) {
+      _add_block(bytes + align);
+      p = _align_up(_next, align);
+    }
+    _next = p + bytes;
+    _allocated += bytes;
+    return reinterpret_cast<void*>(p);
+  }
+
+  std::size_t bytes_allocated () const {return _allocated;}
+
+  // forgets every allocation (everything allocated from the arena must be
+  //  gone), keeping the newest block for reuse
+  void release ()
+  {
+    if (!_blocks) return;
+    _free_blocks(_blocks);
+    _blocks->previous = nullptr;
+    _next = reinterpret_cast<std::uintptr_t>(_blocks) + _header_size();
+    _allocated = 0;
+  }
+
+  // innermost arena alive on this thread (nullptr if there is none)
+  static monotonic_arena* current () {return current_slot();}
+
+  // "private:" stuff
+  struct block_header {
+    block_header *previous;
+  };
+
+  static monotonic_arena*& current_slot ()
+  {
+    static thread_local monotonic_arena *arena = nullptr;
+    return arena;
+  }
+
+  static std::uintptr_t _align_up (std::uintptr_t p, std::size_t align)
+  {
+    return (p + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+  }
+
+  static std::size_t _header_size () {return _align_up(sizeof(block_header), alignof(std::max_align_t));}
+
+  void _add_block (std::size_t min_bytes)
+  {
+    const std::size_t header = _header_size();
+    const std::size_t size = header + (min_bytes > _block_size ? min_bytes : _block_size);
+    auto block = static_cast<block_header*>(::operator new(size));
+    block->previous = _blocks;
+    _blocks = block;
+    _next = reinterpret_cast<std::uintptr_t>(block) + header;
+    _end = reinterpret_cast<std::uintptr_t>(block) + size;
+  }
+
+  // frees the blocks older than keep (all of them for nullptr)
+  void _free_blocks (block_header *keep)
+  {
+    auto b = keep ? keep->previous : _blocks;
+    while (b) {
+      auto previous = b->previous;
+      ::operator delete(b);
+      b = previous;
+    }
+  }
+
+  std::size_t      _block_size;
+  monotonic_arena *_previous;
+  block_header    *_blocks = nullptr;
+  std::uintptr_t   _next = 0;
+  std::uintptr_t   _end = 0;
+  std::size_t      _allocated = 0;
+};
+
+// allocates from a monotonic_arena (deallocation is a no-op)
+template <class T>
+struct arena_allocator {
+  using value_type = T;
+
+  // binds to the current arena of this thread
+  arena_allocator () : arena(monotonic_arena::current())
+  {
+    if (!arena) throw std::logic_error("no monotonic_arena is alive on this thread");
+  }
+  arena_allocator (monotonic_arena &a) noexcept : arena(&a) {}
+  template <class U>
+  arena_allocator (const arena_allocator<U> &other) noexcept : arena(other.arena) {}
+
+  T* allocate (std::size_t n) {return static_cast<T*>(arena->allocate(n*sizeof(T), alignof(T)));}
+  void deallocate (T*, std::size_t) noexcept {}
+
+  monotonic_arena *arena;
+};
+
+template <class T, class U>
+bool operator== (const arena_allocator<T> &a, const arena_allocator<U> &b) {return a.arena == b.arena;}
+template <class T, class U>
+bool operator!= (const arena_allocator<T> &a, const arena_allocator<U> &b) {return a.arena != b.arena;}
+
+
+
+namespace _impl
+{
+
+constexpr std::size_t pool_granularity = alignof(std::max_align_t);
+constexpr std::size_t pool_max_size = 2048;
+
+// free list of Size byte blocks for the calling thread; blocks are carved
+//  from slabs that are never returned, and a block freed on another thread
+//  is handed back to the pool that carved it (which takes it up once its
+//  own free list runs dry), so memory released elsewhere, e.g. by a
+//  list_reclaimer, is reused rather than replaced with new slabs
+template <std::size_t Size>
+struct node_pool {
+  struct free_block {
+    free_block *next;
+  };
+  // (at the start of every slab, which is aligned to its size)
+  struct slab_header {
+    node_pool *owner;
+  };
+  static constexpr std::size_t slab_size = 64*1024;
+  static constexpr std::size_t header_blocks = (sizeof(slab_header) + Size - 1)/Size;
+  static constexpr std::size_t blocks_per_slab = slab_size/Size - header_blocks;
+
+  // (never destroyed, as blocks may still be handed back after its thread
+  //  has exited)
+  static node_pool& local ()
+  {
+    auto &pool = _local_slot();
+    if (!pool) pool = new node_pool;
+    return *pool;
+  }
+
+  void* allocate ()
+  {
+    if (!_free) _free = _handed_back.exchange(nullptr, std::memory_order_acquire);
+    if (!_free) _refill();
+    auto b = _free;
+    _free = b->next;
+    return b;
+  }
+  // (a thread that only frees blocks gets no pool of its own)
+  static void deallocate (void *p) noexcept
+  {
+    auto owner = _slab_of(p)->owner;
+    if (owner == _local_slot()) owner->_push(p);
+    else owner->_hand_back(p);
+  }
+
+  // "private:" stuff
+  static node_pool*& _local_slot () noexcept
+  {
+    static thread_local node_pool *pool = nullptr;
+    return pool;
+  }
+
+  static slab_header* _slab_of (void *p) noexcept
+  {
+    return reinterpret_cast<slab_header*>(reinterpret_cast<std::uintptr_t>(p) & ~static_cast<std::uintptr_t>(slab_size - 1));
+  }
+
+  void _push (void *p) noexcept
+  {
+    auto b = static_cast<free_block*>(p);
+    b->next = _free;
+    _free = b;
+  }
+
+  void _hand_back (void *p) noexcept
+  {
+    auto b = static_cast<free_block*>(p);
+    b->next = _handed_back.load(std::memory_order_relaxed);
+    while (!_handed_back.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed)) {}
+  }
+
+  void _refill ()
+  {
+    auto slab = static_cast<char*>(::operator new(slab_size, std::align_val_t(slab_size)));
+    reinterpret_cast<slab_header*>(slab)->owner = this;
+    for (std::size_t i = header_blocks + blocks_per_slab; i-- > header_blocks;)
+      _push(slab + i*Size);
+  }
+
+  free_block              *_free = nullptr;
+  std::atomic<free_block*> _handed_back{nullptr};
+};
+
+}
+
+// stateless allocator serving single objects from per-thread pools of
+//  fixed size blocks (one pool per size class); arrays and large types go
+//  to operator new
+template <class T>
+struct pool_allocator {
+  static_assert(alignof(T) <= alignof(std::max_align_t), "pool_allocator does not support over-aligned types");
+  using value_type = T;
+  static constexpr std::size_t block_size =
+    (sizeof(T) + _impl::pool_granularity - 1)/_impl::pool_granularity*_impl::pool_granularity;
+  using pooled = std::integral_constant<bool, block_size <= _impl::pool_max_size>;
+
+  pool_allocator () noexcept = default;
+  template <class U>
+  pool_allocator (const pool_allocator<U>&) noexcept {}
+
+  T* allocate (std::size_t n)
+  {
+    if (n == 1) return static_cast<T*>(_allocate(pooled{}));
+    return static_cast<T*>(::operator new(n*sizeof(T)));
+  }
+  void deallocate (T *p, std::size_t n) noexcept
+  {
+    if (n == 1) _deallocate(p, pooled{});
+    else ::operator delete(p);
+  }
+
+  // "private:" stuff
+  static void* _allocate (std::true_type) {return _impl::node_pool<block_size>::local().allocate();}
+  static void* _allocate (std::false_type) {return ::operator new(sizeof(T));}
+  static void _deallocate (void *p, std::true_type) noexcept {_impl::node_pool<block_size>::deallocate(p);}
+  static void _deallocate (void *p, std::false_type) noexcept {::operator delete(p);}
+};
+
+template <class T, class U>
+bool operator== (const pool_allocator<T>&, const pool_allocator<U>&) {return true;}
+template <class T, class U>
+bool operator!= (const pool_allocator<T>&, const pool_allocator<U>&) {return false;}
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef FCPP_ASYNC_H
+#define FCPP_ASYNC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "FC++14/functoid.h"
+#include "FC++14/thread_pool.h"
+
+namespace fcpp
+{
+
+namespace _impl
+{
+
+// shared between the pool task and every copy of an async_suspension
+//  (whoever claims the work first evaluates the suspension, so a consumer
+//  never waits on a task that is still sitting in a queue)
+template <class F>
+struct async_state {
+  using suspension_type = curried_type<F, 0>;
+  using result_type = typename suspension_type::result_type;
+  enum : unsigned char {pending, running, done};
+
+  async_state() = delete;
+  explicit async_state (suspension_type &&s) : susp(std::move(s)) {}
+  explicit async_state (const suspension_type &s) : susp(s) {}
+
+  void run ()
+  {
+    unsigned char expected = pending;
+    if (!status.compare_exchange_strong(expected, running, std::memory_order_acq_rel)) return;
+    try {
+      susp();
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      status.store(done, std::memory_order_release);
+    }
+    finished.notify_all();
+  }
+
+  const result_type& get ()
+  {
+    if (status.load(std::memory_order_acquire) != done) {
+      run();
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [this]() {return status.load(std::memory_order_acquire) == done;});
+    }
+    if (error) std::rethrow_exception(error);
+    return susp.getMemo();
+  }
+
+  suspension_type            susp;
+  std::atomic<unsigned char> status{pending};
+  std::exception_ptr         error;
+  std::mutex                 mutex;
+  std::condition_variable    finished;
+};
+
+}
+
+
+
+// suspension evaluated on a thread pool (calling it returns the memoized
+//  result, blocking only while evaluation is still in flight)
+template <class F>
+struct async_suspension {
+  using func_type = F;
+  using suspension_type = curried_type<F, 0>;
+  using result_type = typename suspension_type::result_type;
+  std::shared_ptr<_impl::async_state<F>> state;
+
+  async_suspension() = delete;
+  explicit async_suspension (std::shared_ptr<_impl::async_state<F>> s) : state(std::move(s)) {}
+
+  // automatic conversion to std::function
+  template <class T, class ...Args>
+  operator std::function<T(Args...)>() const
+  {
+    auto s = state;
+    std::function<T(Args...)> temp{[s](auto&& ...) -> const result_type& {return s->get();}};
+    return temp;
+  }
+
+  bool isReady () const {return state->status.load(std::memory_order_acquire) == state->done;}
+
+  template <class ...Args>
+  const result_type& operator() (Args&& ...) const
+  {
+    return state->get();
+  }
+};
+
+
+
+// ///////////////////////////////////////////////////////////////////////
+// start evaluating a suspension in the background (if the pool is full the
+//  spark is dropped and the suspension is evaluated by its first caller)
+// ///////////////////////////////////////////////////////////////////////
+template <class F>
+auto make_async (curried_type<F, 0> &&c, thread_pool &pool = default_thread_pool())
+{
+  auto state = std::make_shared<_impl::async_state<F>>(std::move(c));
+  pool.try_submit([state]() {state->run();});
+  async_suspension<F> temp(std::move(state));
+  return temp;
+}
+
+template <class F>
+auto make_async (const curried_type<F, 0> &c, thread_pool &pool = default_thread_pool())
+{
+  auto state = std::make_shared<_impl::async_state<F>>(c);
+  pool.try_submit([state]() {state->run();});
+  async_suspension<F> temp(std::move(state));
+  return temp;
+}
+
+
+
+template <class F>
+std::ostream& operator<< (std::ostream& os, const async_suspension<F> &c)
+{
+  os << c();
+  return os;
+}
+
+}
+
+#endif
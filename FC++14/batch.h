@@ -0,0 +1,263 @@
+#ifndef FCPP_BATCH_H
+#define FCPP_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "FC++14/functoid.h"
+
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define FCPP_RESTRICT __restrict
+#else
+#define FCPP_RESTRICT
+#endif
+
+// width of the explicit SIMD batches (GCC/Clang vector extensions)
+#if !defined(FCPP_SIMD_BYTES)
+#if defined(__AVX512F__)
+#define FCPP_SIMD_BYTES 64
+#elif defined(__AVX__)
+#define FCPP_SIMD_BYTES 32
+#else
+#define FCPP_SIMD_BYTES 16
+#endif
+#endif
+
+namespace fcpp
+{
+
+// ////////////////////////////////////////////////////////////////////////
+// batch application over contiguous data
+//
+//  The functoid's func (with everything bound so far) is copied out once,
+//  so the loop neither builds suspensions nor reloads bound arguments
+//  through memory the output might alias; plain loops like these are left
+//  for the compiler to vectorize.
+//
+//  vmap(f, in, n, out)           out[i] = f(in[i])()         (f takes 1 argument)
+//  vzipWith(f, a, b, n, out)     out[i] = f(a[i], b[i])()    (f takes 2 arguments)
+//
+//  Both also take containers with data() and size(); zipping stops at the
+//  shorter input (as zipWith does), and an output shorter than that throws
+//  std::length_error. out may be one of the inputs (in-place application).
+//  The *_simd versions additionally apply
+//  func to whole GCC/Clang vector registers and are only for funcs whose
+//  body is plain arithmetic (anything valid for vector operands); elsewhere
+//  they fall back to the scalar loop.
+// ////////////////////////////////////////////////////////////////////////
+
+namespace _impl
+{
+
+// fixed size blocks need no epilogue, which even the cheap vectorizer
+//  cost model (gcc's default at -O2) accepts
+constexpr std::size_t batch_block = 16;
+
+// (the loops are restrict-qualified only for disjoint ranges, so applying
+//  in place costs the vectorizer its alias information but stays defined)
+inline bool overlapping (const void *a, std::size_t a_bytes, const void *b, std::size_t b_bytes)
+{
+  auto x = reinterpret_cast<std::uintptr_t>(a), y = reinterpret_cast<std::uintptr_t>(b);
+  return x < y + b_bytes && y < x + a_bytes;
+}
+
+template <class G, class T, class R>
+void map_disjoint (const G &g, const T * FCPP_RESTRICT in, std::size_t n, R * FCPP_RESTRICT out)
+{
+  std::size_t i = 0;
+  for (; i + batch_block <= n; i += batch_block)
+    for (std::size_t j = 0; j < batch_block; ++j)
+      out[i + j] = g(in[i + j]);
+  for (; i < n; ++i)
+    out[i] = g(in[i]);
+}
+
+template <class G, class T, class R>
+void map_aliased (const G &g, const T *in, std::size_t n, R *out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    out[i] = g(in[i]);
+}
+
+template <class G, class T, class R>
+R* map_n (const G &g, const T *in, std::size_t n, R *out)
+{
+  if (overlapping(in, n*sizeof(T), out, n*sizeof(R))) map_aliased(g, in, n, out);
+  else map_disjoint(g, in, n, out);
+  return out + n;
+}
+
+template <class G, class T1, class T2, class R>
+void zip_disjoint (const G &g, const T1 * FCPP_RESTRICT a, const T2 * FCPP_RESTRICT b, std::size_t n, R * FCPP_RESTRICT out)
+{
+  std::size_t i = 0;
+  for (; i + batch_block <= n; i += batch_block)
+    for (std::size_t j = 0; j < batch_block; ++j)
+      out[i + j] = g(a[i + j], b[i + j]);
+  for (; i < n; ++i)
+    out[i] = g(a[i], b[i]);
+}
+
+template <class G, class T1, class T2, class R>
+void zip_aliased (const G &g, const T1 *a, const T2 *b, std::size_t n, R *out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    out[i] = g(a[i], b[i]);
+}
+
+template <class G, class T1, class T2, class R>
+R* zip_n (const G &g, const T1 *a, const T2 *b, std::size_t n, R *out)
+{
+  // (the inputs are only read, so they may share memory with each other)
+  if (overlapping(a, n*sizeof(T1), out, n*sizeof(R)) || overlapping(b, n*sizeof(T2), out, n*sizeof(R)))
+    zip_aliased(g, a, b, n, out);
+  else
+    zip_disjoint(g, a, b, n, out);
+  return out + n;
+}
+
+template <class Out>
+void check_output_size (std::size_t n, const Out &out)
+{
+  if (out.size() < n) throw std::length_error("output range is shorter than the input");
+}
+
+#if defined(__GNUC__)
+template <class T>
+struct simd_type {
+  typedef T type __attribute__((vector_size(FCPP_SIMD_BYTES)));
+  static constexpr std::size_t lanes = FCPP_SIMD_BYTES / sizeof(T);
+};
+
+template <class T, class R>
+using use_simd = std::integral_constant<bool,
+  std::is_arithmetic<T>::value && std::is_same<T, R>::value && !std::is_same<T, bool>::value>;
+
+template <class G, class T>
+T* map_simd (const G &g, const T *in, std::size_t n, T *out, std::true_type)
+{
+  using vec = typename simd_type<T>::type;
+  constexpr std::size_t lanes = simd_type<T>::lanes;
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    vec x;
+    std::memcpy(&x, in + i, sizeof(vec));
+    vec y = g(x);
+    std::memcpy(out + i, &y, sizeof(vec));
+  }
+  return map_n(g, in + i, n - i, out + i);
+}
+
+template <class G, class T>
+T* zip_simd (const G &g, const T *a, const T *b, std::size_t n, T *out, std::true_type)
+{
+  using vec = typename simd_type<T>::type;
+  constexpr std::size_t lanes = simd_type<T>::lanes;
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    vec x, y;
+    std::memcpy(&x, a + i, sizeof(vec));
+    std::memcpy(&y, b + i, sizeof(vec));
+    vec z = g(x, y);
+    std::memcpy(out + i, &z, sizeof(vec));
+  }
+  return zip_n(g, a + i, b + i, n - i, out + i);
+}
+#endif
+
+template <class G, class T, class R>
+R* map_simd (const G &g, const T *in, std::size_t n, R *out, std::false_type)
+{
+  return map_n(g, in, n, out);
+}
+
+template <class G, class T1, class T2, class R>
+R* zip_simd (const G &g, const T1 *a, const T2 *b, std::size_t n, R *out, std::false_type)
+{
+  return zip_n(g, a, b, n, out);
+}
+
+}
+
+
+
+template <class F, int N, class T, class R>
+R* vmap (const curried_type<F, N> &f, const T *in, std::size_t n, R *out)
+{
+  static_assert(N == 1, "vmap needs a functoid taking exactly one more argument");
+  const F func = f.func;
+  return _impl::map_n(func, in, n, out);
+}
+
+template <class F, int N, class In, class Out>
+void vmap (const curried_type<F, N> &f, const In &in, Out &out)
+{
+  _impl::check_output_size(in.size(), out);
+  vmap(f, in.data(), in.size(), out.data());
+}
+
+template <class F, int N, class T1, class T2, class R>
+R* vzipWith (const curried_type<F, N> &f, const T1 *a, const T2 *b, std::size_t n, R *out)
+{
+  static_assert(N == 2, "vzipWith needs a functoid taking exactly two more arguments");
+  const F func = f.func;
+  return _impl::zip_n(func, a, b, n, out);
+}
+
+template <class F, int N, class In1, class In2, class Out>
+void vzipWith (const curried_type<F, N> &f, const In1 &a, const In2 &b, Out &out)
+{
+  const auto n = a.size() < b.size() ? a.size() : b.size();
+  _impl::check_output_size(n, out);
+  vzipWith(f, a.data(), b.data(), n, out.data());
+}
+
+
+
+template <class F, int N, class T, class R>
+R* vmap_simd (const curried_type<F, N> &f, const T *in, std::size_t n, R *out)
+{
+  static_assert(N == 1, "vmap_simd needs a functoid taking exactly one more argument");
+  const F func = f.func;
+#if defined(__GNUC__)
+  return _impl::map_simd(func, in, n, out, _impl::use_simd<T, R>{});
+#else
+  return _impl::map_n(func, in, n, out);
+#endif
+}
+
+template <class F, int N, class In, class Out>
+void vmap_simd (const curried_type<F, N> &f, const In &in, Out &out)
+{
+  _impl::check_output_size(in.size(), out);
+  vmap_simd(f, in.data(), in.size(), out.data());
+}
+
+template <class F, int N, class T1, class T2, class R>
+R* vzipWith_simd (const curried_type<F, N> &f, const T1 *a, const T2 *b, std::size_t n, R *out)
+{
+  static_assert(N == 2, "vzipWith_simd needs a functoid taking exactly two more arguments");
+  const F func = f.func;
+#if defined(__GNUC__)
+  return _impl::zip_simd(func, a, b, n, out,
+      std::integral_constant<bool, std::is_same<T1, T2>::value && _impl::use_simd<T1, R>::value>{});
+#else
+  return _impl::zip_n(func, a, b, n, out);
+#endif
+}
+
+template <class F, int N, class In1, class In2, class Out>
+void vzipWith_simd (const curried_type<F, N> &f, const In1 &a, const In2 &b, Out &out)
+{
+  const auto n = a.size() < b.size() ? a.size() : b.size();
+  _impl::check_output_size(n, out);
+  vzipWith_simd(f, a.data(), b.data(), n, out.data());
+}
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef FCPP_FUNCTION_REF_H
+#define FCPP_FUNCTION_REF_H
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "FC++14/functoid.h"
+
+namespace fcpp
+{
+
+// non-owning reference to a callable (two pointers, never allocates)
+//
+//  The referenced callable has to outlive the function_ref and every copy
+//  of it, including the partial applications of a curried function_ref.
+template <class Sig>
+struct function_ref;
+
+template <class R, class ...Args>
+struct function_ref<R(Args...)> {
+  using result_type = R;
+
+  function_ref() = delete;
+  // member-wise copies keep gcc from bouncing both pointers through a
+  //  16 byte vector load right after storing them (a store forwarding stall)
+  function_ref (const function_ref &other) noexcept : _target(other._target), _invoke(other._invoke) {}
+  function_ref& operator= (const function_ref &other) noexcept
+  {
+    _target = other._target;
+    _invoke = other._invoke;
+    return *this;
+  }
+
+  template <class F,
+            class D = typename std::decay<F>::type,
+            typename std::enable_if<!std::is_same<D, function_ref>::value && !std::is_function<typename std::remove_reference<F>::type>::value, int>::type = 0,
+            typename std::enable_if<std::is_convertible<decltype(std::declval<F&>()(std::declval<Args>()...)), R>::value ||
+                                    std::is_void<R>::value, int>::type = 0>
+  function_ref (F &&f) noexcept :
+    _invoke(&_call_object<typename std::remove_reference<F>::type>)
+  {
+    _target.object = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+  }
+
+  function_ref (R (*f)(Args...)) noexcept :
+    _invoke(&_call_function)
+  {
+    _target.function = f;
+  }
+
+  R operator() (Args ...args) const
+  {
+    return _invoke(_target, std::forward<Args>(args)...);
+  }
+
+  // "private:" stuff
+  union target_type {
+    void *object;
+    R (*function) (Args...);
+  };
+
+  template <class T>
+  static R _call_object (target_type t, Args&& ...args)
+  {
+    return (*static_cast<T*>(t.object))(std::forward<Args>(args)...);
+  }
+  static R _call_function (target_type t, Args&& ...args)
+  {
+    return t.function(std::forward<Args>(args)...);
+  }
+
+  target_type _target;
+  R (*_invoke) (target_type, Args&&...);
+};
+
+
+
+// curriable (and composable) without copying the referenced callable into
+//  every partial application
+template <class Ret, class ...Args>
+auto make_curriable (function_ref<Ret(Args...)> f)
+{
+  curried_type<function_ref<Ret(Args...)>, sizeof...(Args)> temp(f);
+  return temp;
+}
+
+// replaces make_curriable(const std::function&) when the std::function
+//  outlives the curried result (and its closure type is unknown)
+template <class Ret, class ...Args>
+auto make_curriable_ref (const std::function<Ret(Args...)> &f)
+{
+  return make_curriable(function_ref<Ret(Args...)>(f));
+}
+template <class Ret, class ...Args>
+auto make_curriable_ref (std::function<Ret(Args...)>&&) = delete;
+
+}
+
+#endif
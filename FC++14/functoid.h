@@ -5,19 +5,27 @@
 #include <utility>
 #include <type_traits>
 #include <functional>
+#include <memory>
+#include <tuple>
+
+#include "FC++14/instrument.h"
 // without any thread safety for the thunk, execution with 
 //  O2 level optimization is identical to hand coded function bodies
 //  (i.e. the compiler can see through all the function calls)
+//  with thread safety, forcing is guarded by an atomic state word so that
+//  retrieving an already forced thunk costs a single acquire load
 #if defined(FCPP_TREADSAFE_SUSP)
-#include <mutex>  // increases execution by 30x
+#include <atomic>
+#include <thread>
 #endif
 
 namespace fcpp {
 
 // forward helper functions
 template <class F, int N> struct curried_type;
-template <int N, class F> auto make_curriable (F &&f);
-template <int N, class F> auto make_eager (const curried_type<F,N> &c);
+template <int N, class F> constexpr auto make_curriable (F &&f);
+template <int N, class F> constexpr auto make_eager (const curried_type<F,N> &c);
+template <class F> struct shared_suspension;
 
 
 
@@ -47,20 +55,197 @@ fix_type<typename std::decay<Functor>::type> fix(Functor&& functor)
 
 
 
+// trampolined recursive lambda helper (constant stack depth)
+//  a self-call in tail position returns a continuation that the driver loop
+//  resumes, so only tail recursion is supported
+struct trampoline_done_tag {};
+struct trampoline_continue_tag {};
+
+template <class R, class ...Args>
+struct trampoline_step {
+  bool done;
+  union {
+    R value;
+    std::tuple<Args...> args;
+  };
+
+  trampoline_step() = delete;
+  trampoline_step (trampoline_done_tag, R &&r) : done(true), value(std::move(r)) {}
+  trampoline_step (trampoline_done_tag, const R &r) : done(true), value(r) {}
+  template <class ...As>
+  trampoline_step (trampoline_continue_tag, As&& ...as) : done(false), args(std::forward<As>(as)...) {}
+  trampoline_step (trampoline_step &&s) : done(s.done)
+  {
+    if (done) new(&value) R(std::move(s.value));
+    else new(&args) std::tuple<Args...>(std::move(s.args));
+  }
+  ~trampoline_step()
+  {
+    if (done) value.~R();
+    else args.~tuple();
+  }
+};
+
+// whether a From converts to a To without narrowing (as in list-initialization)
+template <class From, class To, class = void>
+struct converts_without_narrowing : std::false_type {};
+template <class From, class To>
+struct converts_without_narrowing<From, To, decltype(void(To{std::declval<From>()}))> : std::true_type {};
+
+// passed to the user's function in place of itself
+template <class R, class ...State>
+struct trampoline_self {
+  using step_type = trampoline_step<R, State...>;
+
+  // (a continuation is stored as the state types, which it must not narrow)
+  template <class ...As>
+  step_type operator() (As&& ...as) const
+  {
+    static_assert(sizeof...(As) == sizeof...(State), "a continuation takes one argument per state type");
+    static_assert((converts_without_narrowing<As&&, State>::value && ...),
+        "a continuation argument would be narrowed to its state type");
+    return step_type(trampoline_continue_tag{}, std::forward<As>(as)...);
+  }
+
+  template <class T>
+  step_type done (T&& r) const
+  {
+    return step_type(trampoline_done_tag{}, R(std::forward<T>(r)));
+  }
+};
+
+// (the loop state has the types given to fix_trampolined, not those of the
+//  first call's arguments, which are only converted to them)
+template<class R, typename Functor, class ...State>
+struct trampoline_fix_type {
+  Functor functor;
+
+  template<typename... Args>
+  R operator()(Args&&... args) const
+  {
+    static_assert(sizeof...(Args) == sizeof...(State), "a trampolined function takes one argument per state type");
+    using self_type = trampoline_self<R, State...>;
+    std::tuple<State...> current(static_cast<State>(std::forward<Args>(args))...);
+    while (true) {
+      auto step = resume(self_type{}, current, std::index_sequence_for<State...>{});
+      if (step.done) return std::move(step.value);
+      current = std::move(step.args);
+    }
+  }
+
+  template<class Self, class Tuple, std::size_t ...I>
+  auto resume (Self self, Tuple &current, std::index_sequence<I...>) const
+  { return functor(self, std::move(std::get<I>(current))...); }
+};
+
+// fix_trampolined<R, State...>(f): R is the result, State the types of the
+//  arguments carried from one step to the next
+template<class R, class ...State, typename Functor>
+trampoline_fix_type<R, typename std::decay<Functor>::type, State...> fix_trampolined(Functor&& functor)
+{
+  static_assert(sizeof...(State) > 0, "fix_trampolined needs the state types, e.g. fix_trampolined<R, long, long>");
+  return { std::forward<Functor>(functor) };
+}
+
+// // allows for the following usage
+// auto factorial = fix_trampolined<long double, long double, long double>([](auto&& self, long double n, long double acc)
+// { return n < 2 ? self.done(acc) : self(n - 1, n * acc); });
+// 
+// assert( factorial(5, 1) == 120 )
+
+
+
 // placeholder for curried functions
 struct placeholder {};
 const placeholder _{};
 
 
 
+namespace _impl
+{
+
+// the original callable stored once alongside a flat tuple of the arguments
+//  bound so far (further partial application appends to the tuple rather
+//  than wrapping another closure)
+template <class F, class ...Bound>
+struct bound_front {
+  F f;
+  std::tuple<Bound...> bound;
+
+  // (the return types are spelled out so that is_lvalue_callable can tell
+  //  that move-only bound arguments rule out the const overload)
+  template <std::size_t ...I, class ...Args>
+  constexpr auto call (std::index_sequence<I...>, Args&& ...args) const & ->
+    decltype(f(std::get<I>(bound)..., std::forward<Args>(args)...))
+  {
+    return f(std::get<I>(bound)..., std::forward<Args>(args)...);
+  }
+  template <std::size_t ...I, class ...Args>
+  constexpr auto call (std::index_sequence<I...>, Args&& ...args) &&
+  {
+    return std::move(f)(std::get<I>(std::move(bound))..., std::forward<Args>(args)...);
+  }
+
+  template <class ...Args>
+  constexpr auto operator() (Args&& ...args) const & ->
+    decltype(this->call(std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...))
+  {
+    return call(std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...);
+  }
+  // a temporary hands its bound arguments (and f) on by moving them
+  template <class ...Args>
+  constexpr auto operator() (Args&& ...args) &&
+  {
+    return std::move(*this).call(std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...);
+  }
+};
+
+// whether a const F can be called without arguments (i.e. memoized)
+template <class F, class = void>
+struct is_lvalue_callable : std::false_type {};
+template <class F>
+struct is_lvalue_callable<F, decltype(void(std::declval<const F&>()()))> : std::true_type {};
+
+template <class T> struct is_bound_front : std::false_type {};
+template <class F, class ...Bound> struct is_bound_front<bound_front<F, Bound...>> : std::true_type {};
+
+template <class F, class Arg1,
+          typename std::enable_if<!is_bound_front<typename std::decay<F>::type>::value, int>::type = 0>
+constexpr auto bind_front (F &&f, Arg1 &&a1)
+{
+  bound_front<typename std::decay<F>::type, typename std::decay<Arg1>::type> temp{
+    std::forward<F>(f), std::tuple<typename std::decay<Arg1>::type>(std::forward<Arg1>(a1))};
+  return temp;
+}
+
+template <class F, class ...Bound, class Arg1>
+constexpr auto bind_front (const bound_front<F, Bound...> &b, Arg1 &&a1)
+{
+  bound_front<F, Bound..., typename std::decay<Arg1>::type> temp{
+    b.f, std::tuple_cat(b.bound, std::tuple<typename std::decay<Arg1>::type>(std::forward<Arg1>(a1)))};
+  return temp;
+}
+
+template <class F, class ...Bound, class Arg1>
+constexpr auto bind_front (bound_front<F, Bound...> &&b, Arg1 &&a1)
+{
+  bound_front<F, Bound..., typename std::decay<Arg1>::type> temp{
+    std::move(b.f), std::tuple_cat(std::move(b.bound), std::tuple<typename std::decay<Arg1>::type>(std::forward<Arg1>(a1)))};
+  return temp;
+}
+
+}
+
+
+
 template <class F, int N>
 struct curried_type {
   using func_type = F;
   F func;
 
   curried_type() = delete;
-  curried_type (F &&f) : func(std::move(f)) {}
-  curried_type (const F &f) : func(f) {}
+  constexpr curried_type (F &&f) : func(std::move(f)) {}
+  constexpr curried_type (const F &f) : func(f) {}
 
   // automatic conversion to std::function
   template <class T, class ...Args>
@@ -80,65 +265,51 @@ struct curried_type {
   // normal currying
   template <class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0>
-  auto operator() (Arg1&& a1, Args&& ...args) const &
+  constexpr auto operator() (Arg1&& a1, Args&& ...args) const &
   {
-    const F &f = func; // make locally scoped for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f](auto&& ...an) 
-        {return f(a1, std::forward<decltype(an)>(an)...);}
+    return make_curriable<N - 1>(
+        _impl::bind_front(func, std::forward<Arg1>(a1))
         )(std::forward<Args>(args)...);
-    return temp;
   }
   template <class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0>
-  auto operator() (Arg1&& a1, Args&& ...args) &&
+  constexpr auto operator() (Arg1&& a1, Args&& ...args) &&
   {
-    const F &f = func; // make locally scoped for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& ...an) 
-        {return f(a1, std::forward<decltype(an)>(an)...);}
+    return make_curriable<N - 1>(
+        _impl::bind_front(std::move(func), std::forward<Arg1>(a1))
         )(std::forward<Args>(args)...);
-    return temp;
   }
 
   // chance to capture suspension (must call with exact number of args)
   template <class Arg1, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0>
-  auto operator() (Arg1&& a1) const &
+  constexpr auto operator() (Arg1&& a1) const &
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f](auto&& ...an) 
-        {return f(a1, std::forward<decltype(an)>(an)...);}
+    return make_curriable<N - 1>(
+        _impl::bind_front(func, std::forward<Arg1>(a1))
         );
-    return temp;
   }
   template <class Arg1,
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0>
-  auto operator() (Arg1&& a1) &&
+  constexpr auto operator() (Arg1&& a1) &&
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& ...an) 
-        {return f(a1, std::forward<decltype(an)>(an)...);}
+    return make_curriable<N - 1>(
+        _impl::bind_front(std::move(func), std::forward<Arg1>(a1))
         );
-    return temp;
   }
 
   // placeholder currying
   template <class Arg1, class ...Args, 
            typename std::enable_if<std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0>
-  auto operator() (Arg1&&, Args&& ...args) const &
+  constexpr auto operator() (Arg1&&, Args&& ...args) const &
   {
-    auto temp = make_curriable<N>(F(func)).template new_function<1>(std::forward<Args>(args)...);
-    return temp;
+    return make_curriable<N>(F(func)).template new_function<1>(std::forward<Args>(args)...);
   }
   template <class Arg1, class ...Args, 
            typename std::enable_if<std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0>
-  auto operator() (Arg1&&, Args&& ...args) &&
+  constexpr auto operator() (Arg1&&, Args&& ...args) &&
   {
-    auto temp = make_curriable<N>(std::move(func)).template new_function<1>(std::forward<Args>(args)...);
-    return temp;
+    return make_curriable<N>(std::move(func)).template new_function<1>(std::forward<Args>(args)...);
   }
 
   // placeholder currying (no placeholder)
@@ -146,82 +317,75 @@ struct curried_type {
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 1, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) const &
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) const &
   {
     const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
+    return make_curriable<N - 1>(
         [a1 = std::forward<Arg1>(a1), f](auto&& p1, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 1, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) &&
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) &&
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& p1, auto&& ...an) 
+    return make_curriable<N - 1>(
+        [a1 = std::forward<Arg1>(a1), f = std::move(func)](auto&& p1, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   // NN == 2
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 2, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) const &
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) const &
   {
     const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
+    return make_curriable<N - 1>(
         [a1 = std::forward<Arg1>(a1), f](auto&& p1, auto&& p2, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 2, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) &&
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) &&
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& p1, auto&& p2, auto&& ...an) 
+    return make_curriable<N - 1>(
+        [a1 = std::forward<Arg1>(a1), f = std::move(func)](auto&& p1, auto&& p2, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   // NN == 3
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 3, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) const
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) const
   {
     const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
+    return make_curriable<N - 1>(
         [a1 = std::forward<Arg1>(a1), f](auto&& p1, auto&& p2, auto&& p3, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
           std::forward<decltype(p3)>(p3), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   // NN == 4
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 4, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) const &
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) const &
   {
     const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
+    return make_curriable<N - 1>(
         [a1 = std::forward<Arg1>(a1), f](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
@@ -229,32 +393,29 @@ struct curried_type {
           std::forward<decltype(p4)>(p4), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 4, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) &&
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) &&
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& ...an) 
+    return make_curriable<N - 1>(
+        [a1 = std::forward<Arg1>(a1), f = std::move(func)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
           std::forward<decltype(p3)>(p3), 
           std::forward<decltype(p4)>(p4), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   // NN == 5
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 5, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) const &
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) const &
   {
     const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
+    return make_curriable<N - 1>(
         [a1 = std::forward<Arg1>(a1), f](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
@@ -263,16 +424,14 @@ struct curried_type {
           std::forward<decltype(p5)>(p5), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 5, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) &&
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) &&
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& ...an) 
+    return make_curriable<N - 1>(
+        [a1 = std::forward<Arg1>(a1), f = std::move(func)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
           std::forward<decltype(p3)>(p3), 
@@ -280,16 +439,15 @@ struct curried_type {
           std::forward<decltype(p5)>(p5), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   // NN == 6
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 6, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) const &
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) const &
   {
     const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
+    return make_curriable<N - 1>(
         [a1 = std::forward<Arg1>(a1), f](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
@@ -299,16 +457,14 @@ struct curried_type {
           std::forward<decltype(p6)>(p6), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 6, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) &&
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) &&
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& ...an) 
+    return make_curriable<N - 1>(
+        [a1 = std::forward<Arg1>(a1), f = std::move(func)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
           std::forward<decltype(p3)>(p3), 
@@ -317,16 +473,15 @@ struct curried_type {
           std::forward<decltype(p6)>(p6), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   // NN == 7
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 7, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) const &
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) const &
   {
     const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
+    return make_curriable<N - 1>(
         [a1 = std::forward<Arg1>(a1), f](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& p7, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
@@ -337,16 +492,14 @@ struct curried_type {
           std::forward<decltype(p7)>(p7), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 7, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) &&
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) &&
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& p7, auto&& ...an) 
+    return make_curriable<N - 1>(
+        [a1 = std::forward<Arg1>(a1), f = std::move(func)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& p7, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
           std::forward<decltype(p3)>(p3), 
@@ -356,16 +509,15 @@ struct curried_type {
           std::forward<decltype(p7)>(p7), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   // NN == 8
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 8, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) const &
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) const &
   {
     const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
+    return make_curriable<N - 1>(
         [a1 = std::forward<Arg1>(a1), f](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& p7, auto&& p8, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
@@ -377,16 +529,14 @@ struct curried_type {
           std::forward<decltype(p8)>(p8), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
   template <int NN, class Arg1, class ...Args, 
            typename std::enable_if<!std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0,
            typename std::enable_if<NN == 8, int>::type = 0>
-  auto new_function (Arg1&& a1, Args&& ...args) &&
+  constexpr auto new_function (Arg1&& a1, Args&& ...args) &&
   {
-    const F &f = func; // make local for copying into lambda
-    auto temp = make_curriable<N - 1>(
-        [a1 = std::forward<Arg1>(a1), f = std::move(f)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& p7, auto&& p8, auto&& ...an) 
+    return make_curriable<N - 1>(
+        [a1 = std::forward<Arg1>(a1), f = std::move(func)](auto&& p1, auto&& p2, auto&& p3, auto&& p4, auto&& p5, auto&& p6, auto&& p7, auto&& p8, auto&& ...an) 
         {return f(std::forward<decltype(p1)>(p1), 
           std::forward<decltype(p2)>(p2), 
           std::forward<decltype(p3)>(p3), 
@@ -397,45 +547,38 @@ struct curried_type {
           std::forward<decltype(p8)>(p8), 
           a1, std::forward<decltype(an)>(an)...);}
         ).template new_function<NN>(std::forward<Args>(args)...);
-    return temp;
   }
 
   // placeholder currying (with placeholder)
   template <int NN, class Arg1, class ...Args, typename std::enable_if<std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0>
-  auto new_function (Arg1&&, Args&& ...args) const &
+  constexpr auto new_function (Arg1&&, Args&& ...args) const &
   {
-    auto temp = make_curriable<N>(F(func)).template new_function<NN + 1>(std::forward<Args>(args)...);
-    return temp;
+    return make_curriable<N>(F(func)).template new_function<NN + 1>(std::forward<Args>(args)...);
   }
   template <int NN, class Arg1, class ...Args, typename std::enable_if<std::is_same<typename std::decay<Arg1>::type, placeholder>::value, int>::type = 0>
-  auto new_function (Arg1&&, Args&& ...args) &&
+  constexpr auto new_function (Arg1&&, Args&& ...args) &&
   {
-    auto temp = make_curriable<N>(std::move(func)).template new_function<NN + 1>(std::forward<Args>(args)...);
-    return temp;
+    return make_curriable<N>(std::move(func)).template new_function<NN + 1>(std::forward<Args>(args)...);
   }
 
   template <int>
-  auto new_function () const &
+  constexpr auto new_function () const &
   {
-    auto temp = make_curriable<N>(F(func));
-    return temp;
+    return make_curriable<N>(F(func));
   }
   template <int>
-  auto new_function () &&
+  constexpr auto new_function () &&
   {
-    auto temp = make_curriable<N>(std::move(func));
-    return temp;
+    return make_curriable<N>(std::move(func));
   }
 
-  auto operator() () const &
+  constexpr auto operator() () const &
   {
-    auto temp = make_curriable<N>(F(func));
-    return temp;
+    return make_curriable<N>(F(func));
   }
-  auto operator() () &&
+  constexpr auto operator() () &&
   {
-    auto temp = make_curriable<N>(std::move(func));
-    return temp;
+    return make_curriable<N>(std::move(func));
   }
 };
 
@@ -578,86 +721,270 @@ struct curried_type {
 
 
 
+namespace _impl
+{
+
+// memo of a suspension (a union rather than aligned_storage, which constant
+//  expressions cannot look into)
+template <class R, bool = std::is_trivially_destructible<R>::value>
+union memo_storage {
+  char none;
+  R    value;
+
+  constexpr memo_storage () : none() {}
+};
+template <class R>
+union memo_storage<R, false> {
+  char none;
+  R    value;
+
+  constexpr memo_storage () : none() {}
+  ~memo_storage () {}
+};
+
+template <class Derived, class R>
+struct suspension_state {
+#if defined(FCPP_TREADSAFE_SUSP)
+  // unforced -> forcing -> forced (only the thread winning the CAS calls func)
+  enum : unsigned char {unforced, forcing, forced};
+  mutable std::atomic<unsigned char> state;
+#endif
+
+  mutable memo_storage<R> result;
+
+  using thunk_type = R const & (*) (const Derived*);
+#if !defined(FCPP_TREADSAFE_SUSP)
+  mutable thunk_type thunk;
+#endif
+
+#if defined(FCPP_TREADSAFE_SUSP)
+  constexpr suspension_state () : state(unforced), result() {}
+#else
+  constexpr suspension_state () : result(), thunk(Derived::initialThunk()) {}
+#endif
+
+  bool isForced () const
+  {
+#if defined(FCPP_TREADSAFE_SUSP)
+    return state.load(std::memory_order_acquire) == forced;
+#else
+    return thunk == &Derived::thunkGet;
+#endif
+  }
+};
+
+// only results that need destroying give the suspension a destructor, so a
+//  suspension with a literal func and result is a literal type itself
+template <class Derived, class R, bool = std::is_trivially_destructible<R>::value>
+struct suspension_storage : suspension_state<Derived, R> {};
+template <class Derived, class R>
+struct suspension_storage<Derived, R, false> : suspension_state<Derived, R> {
+  ~suspension_storage ()
+  {
+    if (this->isForced()) this->result.value.~R();
+  }
+};
+
+}
+
 // suspension (result of func() should be either copy- or move-constructable)
 template <class F>
-struct curried_type<F, 0> {
+struct curried_type<F, 0> :
+  _impl::suspension_storage<curried_type<F, 0>, typename std::decay<decltype(std::declval<F>()())>::type> {
   using func_type = F;
+  // (deduced from the consuming call so move-only bound arguments are fine
+  //  as long as the suspension is only ever evaluated as a temporary)
+  using result_type = typename std::decay<decltype(std::declval<F>()())>::type;
+  using storage_type = _impl::suspension_storage<curried_type<F, 0>, result_type>;
+  using typename storage_type::thunk_type;
+  using storage_type::result;
+  using storage_type::isForced;
 #if defined(FCPP_TREADSAFE_SUSP)
-  mutable std::once_flag once_flag;
+  using storage_type::state;
+  using storage_type::unforced;
+  using storage_type::forcing;
+  using storage_type::forced;
+#else
+  using storage_type::thunk;
 #endif
 
   F func;
 
-  using result_type = typename std::decay<decltype(func())>::type;
-  mutable typename std::aligned_storage<sizeof(result_type), alignof(result_type)>::type result;
-
-  using thunk_type = result_type const & (*) (const curried_type<F, 0>*);
-  mutable thunk_type thunk;
-
   // thunk
   static const result_type& thunkForce (const curried_type<F, 0> *susp)
   {
     return susp->setMemo();
   }
+  // a suspension whose func holds move-only arguments has no memoizing
+  //  thunk at all (its memoizing operator() is rejected at compile time)
+  static constexpr thunk_type initialThunk () {return initialThunk(_impl::is_lvalue_callable<F>{});}
+  static constexpr thunk_type initialThunk (std::true_type) {return &thunkForce;}
+  static constexpr thunk_type initialThunk (std::false_type) {return nullptr;}
   // thunk
   static const result_type& thunkGet (const curried_type<F, 0> *susp)
   {
+    FCPP_INSTRUMENT_COUNT(thunk_gets);
     return susp->getMemo();
   }
 
   const result_type& getMemo () const
   {
-    return reinterpret_cast<result_type&>(result);
+    return result.value;
   }
 
-#if defined(FCPP_TREADSAFE_SUSP)
-  void setMemo_impl () const
+  // call only after result has been constructed
+  void markForced () const
   {
-    new(&result) result_type(func());
+#if defined(FCPP_TREADSAFE_SUSP)
+    state.store(forced, std::memory_order_release);
+#if defined(__cpp_lib_atomic_wait)
+    state.notify_all();
+#endif
+#else
     thunk = &thunkGet;
-  }
 #endif
+  }
+
+  void constructMemo () const
+  {
+    new(&result.value) result_type(func());
+  }
 
   const result_type& setMemo () const
   {
 #if defined(FCPP_TREADSAFE_SUSP)
-    std::call_once(once_flag, [this]() {this->setMemo_impl();});
+    unsigned char s = state.load(std::memory_order_acquire);
+    while (s != forced) {
+      if (s == unforced) {
+        if (!state.compare_exchange_weak(s, forcing, std::memory_order_acquire, std::memory_order_acquire))
+          continue;
+        FCPP_INSTRUMENT_COUNT(thunk_forces);
+        try {
+          constructMemo();
+        }
+        catch (...) {
+          // let a contender (or a later call) retry
+          state.store(unforced, std::memory_order_release);
+#if defined(__cpp_lib_atomic_wait)
+          state.notify_all();
+#endif
+          throw;
+        }
+        markForced();
+        return this->getMemo();
+      }
+      // another thread is forcing
+#if defined(__cpp_lib_atomic_wait)
+      state.wait(forcing, std::memory_order_acquire);
 #else
-    // should be same as setMemo_impl()
-    new(&result) result_type(func());
-    thunk = &thunkGet;
+      std::this_thread::yield();
+#endif
+      s = state.load(std::memory_order_acquire);
+    }
+    // forced by another thread
+    FCPP_INSTRUMENT_COUNT(thunk_gets);
+#else
+    FCPP_INSTRUMENT_COUNT(thunk_forces);
+    constructMemo();
+    markForced();
 #endif
     return this->getMemo();
   }
 
+  // carry an existing memo across (an unforced or currently forcing
+  //  source leaves the copy unforced)
+  void copyMemo (const curried_type &c)
+  {
+    if (!c.isForced()) return;
+    new(&result.value) result_type(c.getMemo());
+    markForced();
+  }
+  void moveMemo (curried_type &c)
+  {
+    if (!c.isForced()) return;
+    new(&result.value) result_type(std::move(c.result.value));
+    markForced();
+  }
+
+  // lets type-erased holders (e.g. small_function) store suspensions inline
+  using nothrow_move = std::integral_constant<bool,
+        std::is_nothrow_move_constructible<F>::value && std::is_nothrow_move_constructible<result_type>::value>;
+
   curried_type() = delete;
+  // (std::atomic is neither copyable nor movable, nor is the memo union)
+  curried_type (curried_type &&c) noexcept(nothrow_move::value) : storage_type(), func(std::move(c.func)) {moveMemo(c);}
+  curried_type (const curried_type &c) : storage_type(), func(c.func) {copyMemo(c);}
+  // (no destructor here: suspension_storage only has one when the result
+  //  needs destroying, which keeps temporary suspensions free of atomics)
+
+  constexpr curried_type (F &&f) : storage_type(), func(std::move(f)) {FCPP_INSTRUMENT_COUNT(suspensions_created);}
+  constexpr curried_type (const F &f) : storage_type(), func(f) {FCPP_INSTRUMENT_COUNT(suspensions_created);}
+
+  template <class ...Args>
+  const result_type& operator() (Args&& ...) const &
+  {
+    static_assert(_impl::is_lvalue_callable<F>::value,
+        "suspension with move-only arguments can only be evaluated as a temporary");
 #if defined(FCPP_TREADSAFE_SUSP)
-  // needed for mutex approach
-  curried_type (curried_type &&c) : func(std::move(c.func)), thunk(&thunkForce) {}
-  curried_type (const curried_type &c) : func(c.func), thunk(&thunkForce) {}
+    // hot path: a single acquire load once forced
+    if (state.load(std::memory_order_acquire) == forced) {
+      FCPP_INSTRUMENT_COUNT(thunk_gets);
+      return getMemo();
+    }
+    return setMemo();
 #else
-  curried_type (curried_type &&c) = default;
-  curried_type (const curried_type &c) = default;
+    return thunk(this);
 #endif
-  ~curried_type() 
+  }
+  template <class ...Args>
+  constexpr auto operator() (Args&& ...) &&
+  {
+    // no need to memoize value if temporary (so func can give up what it holds)
+    FCPP_INSTRUMENT_COUNT(temporary_evaluations);
+    return std::move(func)();
+  }
+
+  // all copies of the returned suspension share a single memo
+  auto share () const &
   {
-    if (thunk == &thunkGet) 
-      reinterpret_cast<result_type&>(result).~result_type();
+    shared_suspension<F> temp(std::make_shared<const curried_type<F, 0>>(*this));
+    return temp;
+  }
+  auto share () &&
+  {
+    shared_suspension<F> temp(std::make_shared<const curried_type<F, 0>>(std::move(*this)));
+    return temp;
   }
+};
 
-  curried_type (F &&f) : func(std::move(f)), thunk(&thunkForce) {}
-  curried_type (const F &f) : func(f), thunk(&thunkForce) {}
 
-  template <class ...Args>
-  const result_type& operator() (Args&& ...) const &
+
+// suspension whose copies all refer to one memoized result
+template <class F>
+struct shared_suspension {
+  using func_type = F;
+  using suspension_type = curried_type<F, 0>;
+  using result_type = typename suspension_type::result_type;
+  std::shared_ptr<const suspension_type> susp;
+
+  shared_suspension() = delete;
+  explicit shared_suspension (std::shared_ptr<const suspension_type> s) : susp(std::move(s)) {}
+
+  // automatic conversion to std::function
+  template <class T, class ...Args>
+  operator std::function<T(Args...)>() const
   {
-    return thunk(this);
+    auto s = susp;
+    std::function<T(Args...)> temp{[s](auto&& ...) -> const result_type& {return (*s)();}};
+    return temp; 
   }
+
+  bool isForced () const {return susp->isForced();}
+
   template <class ...Args>
-  auto operator() (Args&& ...) &&
+  const result_type& operator() (Args&& ...) const
   {
-    // no need to memoize value if temporary
-    return func();
+    return (*susp)();
   }
 };
 
@@ -665,27 +992,25 @@ struct curried_type<F, 0> {
 
 
 template <int N, class F>
-auto make_curriable (F &&f)
+constexpr auto make_curriable (F &&f)
 {
-  curried_type<typename std::decay<F>::type, N> temp(std::forward<F>(f));
-  return temp;
+  return curried_type<typename std::decay<F>::type, N>(std::forward<F>(f));
 }
 
 template <class Ret, class ...Args>
-auto make_curriable (Ret (*f)(Args ...args))
+constexpr auto make_curriable (Ret (*f)(Args ...args))
 {
-  curried_type<typename std::decay<decltype(f)>::type, sizeof...(Args)> temp(f);
-  return temp;
+  return curried_type<typename std::decay<decltype(f)>::type, sizeof...(Args)>(f);
 }
 
 template <class F, class Ret, class T, class ...Args>
-auto make_curriable (F &&f, Ret (T::*)(Args ...args) const)
+constexpr auto make_curriable (F &&f, Ret (T::*)(Args ...args) const)
 {
-  curried_type<typename std::decay<F>::type, sizeof...(Args)> temp(std::forward<F>(f));
-  return temp;
+  return curried_type<typename std::decay<F>::type, sizeof...(Args)>(std::forward<F>(f));
 }
 
 // this is incredibly inefficient, but may be necessary in some cases
+//  (make_curriable_ref in FC++14/function_ref.h avoids the copies)
 template <class Ret, class ...Args>
 auto make_curriable (const std::function<Ret(Args...)> &f)
 {
@@ -720,9 +1045,10 @@ auto make_curriable (const curried_type<F,N> &c, const std::function<Ret(Args...
 template <class T>
 auto make_suspension_for_value (T&& val)
 {
-  auto temp = make_curriable<0>([val = std::forward<T>(val)]() {return val;});
-  new(&temp.result) typename std::decay<T>::type(std::forward<T>(val));
-  temp.thunk = &decltype(temp)::thunkGet;
+  using value_type = typename std::decay<T>::type;
+  auto temp = make_curriable<0>([val = value_type(val)]() {return val;});
+  new(&temp.result.value) value_type(std::forward<T>(val));
+  temp.markForced();
   return temp;
 }
 
@@ -731,29 +1057,95 @@ auto make_suspension_for_value (T&& val)
 // ////////////////////
 // composition operator
 // ////////////////////
-template <class F1, class F2, int N2>
-auto operator* (const curried_type<F1, 1> &c1, const curried_type<F2, N2> &c2)
+namespace _impl
+{
+
+// flattened composition: stage 0 is applied last, the final stage receives
+//  the arguments (each stage's func is called directly, so no suspension is
+//  built between stages)
+template <class ...Fs>
+struct pipeline {
+  std::tuple<Fs...> stages;
+
+  template <class ...Args>
+  constexpr auto operator() (Args&& ...args) const
+  {
+    return call<0>(std::integral_constant<bool, sizeof...(Fs) == 1>{}, std::forward<Args>(args)...);
+  }
+
+  // innermost stage
+  template <std::size_t I, class ...Args>
+  constexpr auto call (std::true_type, Args&& ...args) const
+  {
+    return std::get<I>(stages)(std::forward<Args>(args)...);
+  }
+  // intermediate results are handed on as const lvalues (as they were when
+  //  every stage was applied through a curried_type)
+  template <std::size_t I, class ...Args>
+  constexpr auto call (std::false_type, Args&& ...args) const
+  {
+    const auto &inner = call<I + 1>(std::integral_constant<bool, I + 2 == sizeof...(Fs)>{}, std::forward<Args>(args)...);
+    return std::get<I>(stages)(inner);
+  }
+};
+
+template <class T> struct is_pipeline : std::false_type {};
+template <class ...Fs> struct is_pipeline<pipeline<Fs...>> : std::true_type {};
+
+template <class ...Fs>
+constexpr auto stages_of (const pipeline<Fs...> &p) {return p.stages;}
+template <class ...Fs>
+constexpr auto stages_of (pipeline<Fs...> &&p) {return std::move(p.stages);}
+template <class F,
+          typename std::enable_if<!is_pipeline<typename std::decay<F>::type>::value, int>::type = 0>
+constexpr auto stages_of (F &&f) {return std::tuple<typename std::decay<F>::type>(std::forward<F>(f));}
+
+template <class ...Fs>
+constexpr auto make_pipeline (std::tuple<Fs...> &&stages)
 {
-  auto temp = make_curriable<N2>([c1, c2](auto&& ...args) {return c1(c2(std::forward<decltype(args)>(args)...)())();});
+  pipeline<Fs...> temp{std::move(stages)};
   return temp;
 }
+
+template <class F1, class F2>
+constexpr auto compose (F1 &&f1, F2 &&f2)
+{
+  return make_pipeline(std::tuple_cat(stages_of(std::forward<F1>(f1)), stages_of(std::forward<F2>(f2))));
+}
+
+// a stage is the underlying func, except for a suspension (whose memo is kept)
+template <class F, int N,
+          typename std::enable_if<N != 0, int>::type = 0>
+constexpr const F& stage_of (const curried_type<F, N> &c) {return c.func;}
+template <class F, int N,
+          typename std::enable_if<N != 0, int>::type = 0>
+constexpr F&& stage_of (curried_type<F, N> &&c) {return std::move(c.func);}
+template <class F>
+constexpr const curried_type<F, 0>& stage_of (const curried_type<F, 0> &c) {return c;}
+template <class F>
+constexpr curried_type<F, 0>&& stage_of (curried_type<F, 0> &&c) {return std::move(c);}
+
+}
+
 template <class F1, class F2, int N2>
-auto operator* (curried_type<F1, 1>&& c1, const curried_type<F2, N2> &c2)
+constexpr auto operator* (const curried_type<F1, 1> &c1, const curried_type<F2, N2> &c2)
 {
-  auto temp = make_curriable<N2>([c1 = std::move(c1), c2](auto&& ...args) {return c1(c2(std::forward<decltype(args)>(args)...)())();});
-  return temp;
+  return make_curriable<N2>(_impl::compose(c1.func, _impl::stage_of(c2)));
 }
 template <class F1, class F2, int N2>
-auto operator* (const curried_type<F1, 1> &c1, curried_type<F2, N2>&& c2)
+constexpr auto operator* (curried_type<F1, 1>&& c1, const curried_type<F2, N2> &c2)
 {
-  auto temp = make_curriable<N2>([c1, c2 = std::move(c2)](auto&& ...args) {return c1(c2(std::forward<decltype(args)>(args)...)())();});
-  return temp;
+  return make_curriable<N2>(_impl::compose(std::move(c1.func), _impl::stage_of(c2)));
 }
 template <class F1, class F2, int N2>
-auto operator* (curried_type<F1, 1>&& c1, curried_type<F2, N2>&& c2)
+constexpr auto operator* (const curried_type<F1, 1> &c1, curried_type<F2, N2>&& c2)
 {
-  auto temp = make_curriable<N2>([c1 = std::move(c1), c2 = std::move(c2)](auto&& ...args) {return c1(c2(std::forward<decltype(args)>(args)...)())();});
-  return temp;
+  return make_curriable<N2>(_impl::compose(c1.func, _impl::stage_of(std::move(c2))));
+}
+template <class F1, class F2, int N2>
+constexpr auto operator* (curried_type<F1, 1>&& c1, curried_type<F2, N2>&& c2)
+{
+  return make_curriable<N2>(_impl::compose(std::move(c1.func), _impl::stage_of(std::move(c2))));
 }
 
 
@@ -762,16 +1154,14 @@ auto operator* (curried_type<F1, 1>&& c1, curried_type<F2, N2>&& c2)
 // infix operator
 // //////////////
 template <class T, class F, int N>
-auto operator% (T&& val, curried_type<F, N>&& c)
+constexpr auto operator% (T&& val, curried_type<F, N>&& c)
 {
-  auto temp = c(std::forward<decltype(val)>(val));
-  return temp;
+  return c(std::forward<decltype(val)>(val));
 }
 template <class T, class F, int N>
-auto operator% (T&& val, const curried_type<F, N> &c)
+constexpr auto operator% (T&& val, const curried_type<F, N> &c)
 {
-  auto temp = c(std::forward<decltype(val)>(val));
-  return temp;
+  return c(std::forward<decltype(val)>(val));
 }
 
 
@@ -780,16 +1170,14 @@ auto operator% (T&& val, const curried_type<F, N> &c)
 // infix and function call operator
 // ////////////////////////////////
 template <class T, class F, int N>
-auto operator% (curried_type<F, N>&& c, T&& val)
+constexpr auto operator% (curried_type<F, N>&& c, T&& val)
 {
-  auto temp = c(std::forward<decltype(val)>(val));
-  return temp;
+  return c(std::forward<decltype(val)>(val));
 }
 template <class T, class F, int N>
-auto operator% (const curried_type<F, N> &c, T&& val)
+constexpr auto operator% (const curried_type<F, N> &c, T&& val)
 {
-  auto temp = c(std::forward<decltype(val)>(val));
-  return temp;
+  return c(std::forward<decltype(val)>(val));
 }
 
 
@@ -798,7 +1186,7 @@ auto operator% (const curried_type<F, N> &c, T&& val)
 // allows for eager usage without casting to std::function and bypassing suspension
 // ////////////////////////////////////////////////////////////////////////////////
 template <int N, class F>
-auto make_eager (curried_type<F,N> &&c)
+constexpr auto make_eager (curried_type<F,N> &&c)
 {
   return [c = std::move(c)](auto&& ...args) {
     static_assert(sizeof...(args) == N, "supplied the incorrect number of arguments to eager function"); 
@@ -807,7 +1195,7 @@ auto make_eager (curried_type<F,N> &&c)
 }
 
 template <int N, class F>
-auto make_eager (const curried_type<F,N> &c)
+constexpr auto make_eager (const curried_type<F,N> &c)
 {
   return [&c](auto&& ...args) {
     static_assert(sizeof...(args) == N, "supplied the incorrect number of arguments to eager function");
@@ -836,6 +1224,13 @@ std::ostream& operator<< (std::ostream& os, const curried_type<F,N> &c)
   return os;
 }
 
+template <class F>
+std::ostream& operator<< (std::ostream& os, const shared_suspension<F> &c) 
+{
+  os << c();
+  return os;
+}
+
 
 }
 
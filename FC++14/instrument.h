@@ -0,0 +1,182 @@
+#ifndef FCPP_INSTRUMENT_H
+#define FCPP_INSTRUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+// counting is compiled out entirely unless FCPP_INSTRUMENT is defined; the
+//  stats API stays available (and reports zeros) either way
+#if defined(FCPP_INSTRUMENT)
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace fcpp
+{
+
+namespace instrument
+{
+
+enum counter : std::size_t {
+  suspensions_created,    // curried_type<F,0> built from a function
+  thunk_forces,           // memoizing suspension evaluated its function
+  thunk_gets,             // memoized result read back
+  temporary_evaluations,  // rvalue suspension evaluated without memoizing
+  list_nodes,             // ListSuspensionManager constructed
+  list_tails_generated,   // List::tail ran _tail_gen
+  list_tails_reused,      // List::tail returned the memoized _tail
+  memo_hits,              // make_memoized cache hit
+  memo_misses,            // make_memoized cache miss
+  counter_count
+};
+
+inline const char* counter_name (counter c)
+{
+  static const char *names[counter_count] = {
+    "suspensions_created", "thunk_forces", "thunk_gets", "temporary_evaluations",
+    "list_nodes", "list_tails_generated", "list_tails_reused", "memo_hits", "memo_misses"};
+  return names[c];
+}
+
+// totals of all counters (over all threads) at some point in time
+struct stats {
+  std::uint64_t values[counter_count] = {};
+
+  std::uint64_t operator[] (counter c) const {return values[c];}
+
+  stats& operator+= (const stats &other)
+  {
+    for (std::size_t i = 0; i < counter_count; ++i) values[i] += other.values[i];
+    return *this;
+  }
+  stats operator- (const stats &other) const
+  {
+    stats temp;
+    for (std::size_t i = 0; i < counter_count; ++i) temp.values[i] = values[i] - other.values[i];
+    return temp;
+  }
+};
+
+inline std::ostream& operator<< (std::ostream &os, const stats &s)
+{
+  for (std::size_t i = 0; i < counter_count; ++i)
+    os << (i ? ", " : "") << counter_name(static_cast<counter>(i)) << "=" << s.values[i];
+  return os;
+}
+
+
+
+#if defined(FCPP_INSTRUMENT)
+namespace _impl
+{
+
+// only the owning thread writes its counters, so an increment is a relaxed
+//  load and store (no read-modify-write)
+struct thread_counters {
+  std::atomic<std::uint64_t> values[counter_count];
+
+  thread_counters () {for (auto &v : values) v.store(0, std::memory_order_relaxed);}
+  void add_to (stats &s) const
+  {
+    for (std::size_t i = 0; i < counter_count; ++i) s.values[i] += values[i].load(std::memory_order_relaxed);
+  }
+};
+
+struct registry {
+  std::mutex mutex;
+  std::vector<const thread_counters*> live;
+  stats retired;  // counts of threads that have exited
+
+  // never destroyed, so threads outliving main can still retire their counts
+  static registry& instance ()
+  {
+    static registry *r = new registry;
+    return *r;
+  }
+};
+
+struct thread_slot {
+  thread_counters counters;
+
+  thread_slot ()
+  {
+    auto &r = registry::instance();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.live.push_back(&counters);
+  }
+  ~thread_slot ()
+  {
+    auto &r = registry::instance();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    counters.add_to(r.retired);
+    r.live.erase(std::find(r.live.begin(), r.live.end(), &counters));
+  }
+};
+
+inline void count (counter c)
+{
+  static thread_local thread_slot slot;
+  auto &v = slot.counters.values[c];
+  v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+}
+
+// aggregates the counters of all threads
+inline stats snapshot ()
+{
+  auto &r = _impl::registry::instance();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  stats s = r.retired;
+  for (auto counters : r.live)
+    counters->add_to(s);
+  return s;
+}
+
+// (constant evaluation, e.g. of a constexpr functoid, counts nothing)
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define FCPP_INSTRUMENT_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+#if !defined(FCPP_INSTRUMENT_CONSTANT_EVALUATED)
+#define FCPP_INSTRUMENT_CONSTANT_EVALUATED() false
+#endif
+
+#define FCPP_INSTRUMENT_COUNT(c) \
+  (FCPP_INSTRUMENT_CONSTANT_EVALUATED() ? (void)0 : ::fcpp::instrument::_impl::count(::fcpp::instrument::c))
+#else
+inline stats snapshot () {return stats();}
+
+#define FCPP_INSTRUMENT_COUNT(c) ((void)0)
+#endif
+
+
+
+// counts accumulated (by all threads) since construction; optionally
+//  reported when the scope ends
+struct scoped_stats {
+  explicit scoped_stats (const char *label = nullptr, std::ostream *report = nullptr) :
+    _label(label), _report(report), _start(snapshot()) {}
+  scoped_stats(const scoped_stats&) = delete;
+  scoped_stats& operator=(const scoped_stats&) = delete;
+  ~scoped_stats ()
+  {
+    if (_report) *_report << (_label ? _label : "stats") << ": " << delta() << std::endl;
+  }
+
+  stats delta () const {return snapshot() - _start;}
+
+  // "private:" stuff
+  const char   *_label;
+  std::ostream *_report;
+  stats         _start;
+};
+
+}
+
+}
+
+#endif
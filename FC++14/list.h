@@ -1,6 +1,7 @@
 #ifndef FCPP_LIST_H
 #define FCPP_LIST_H
 
+#include <atomic>
 #include <iterator>
 #include <memory>
 #include <utility>
@@ -8,6 +9,8 @@
 #include <functional>
 
 #include "FC++14/functoid.h"
+#include "FC++14/small_function.h"
+#include "FC++14/refcount.h"
 
 namespace fcpp
 {
@@ -31,10 +34,25 @@ namespace fcpp
 //  object no longer points to it. The links directed from the M's to L's are 
 //  really just functions that generate to requisite L on demand. Users 
 //  typically hold on to the L on the lower left.
+//
+//  An M may also hold a whole block of already evaluated elements (a chunk
+//  filled by make_chunked_list); an L then also records its position in the
+//  block, so stepping through the block needs neither a new M nor a tail
+//  generator. The links between M's always start at the front of a block.
+//
+//  M's are reference counted intrusively; R is the refcount policy (see
+//  FC++14/refcount.h), atomic_refcount for lists shared between threads or
+//  local_refcount for the cheapest traversal on a single thread.
 
-template<class T, class A = std::allocator<T>>
+template<class T, class A = std::allocator<T>, class R = default_refcount>
 struct List;
 
+template<class T, class G, class A = std::allocator<T>, class R = default_refcount>
+List<T, A, R> make_chunked_list (G fill, const A &alloc = A());
+
+template<class T, class A = std::allocator<T>, class R = default_refcount>
+struct consuming_stream;
+
 
 // struct NIL_t {NIL_t () = default; template<class T, class A> operator List<T,A>() {return List<T,A>();}} NIL;
 
@@ -43,167 +61,520 @@ struct List;
 namespace _impl
 {
 
+// any nullary callable producing a T (that is not itself a T)
+template<class Thunk, class T, class = void>
+struct is_list_thunk : std::false_type {};
+template<class Thunk, class T>
+struct is_list_thunk<Thunk, T, typename std::enable_if<
+  std::is_convertible<decltype(std::declval<typename std::decay<Thunk>::type&>()()), T>::value>::type> :
+  std::integral_constant<bool, !std::is_convertible<Thunk, T>::value> {};
+
+// element of a value node (returned by reference, like a forced suspension)
+template<class T>
+struct list_value {
+  T value;
+  const T& operator() () const {return value;}
+};
+
 template<class T>
+list_value<typename std::decay<T>::type> make_list_value (T &&val) {return {std::forward<T>(val)};}
+
+// element of another node, handed out by reference (keeps that node alive)
+template<class Node>
+struct list_element_ref {
+  intrusive_ptr<const Node> node;
+  std::size_t               pos;
+  const auto& operator() () const {return (*node)[pos];}
+};
+
+template<class T> struct is_list_element_ref : std::false_type {};
+template<class Node> struct is_list_element_ref<list_element_ref<Node>> : std::true_type {};
+
+// memoizing suspension for an element thunk; a thunk producing something
+//  other than a T is converted first, so the memo is a T the node can hand
+//  out by reference (another node's element needs no suspension of its own)
+template<class T, class Thunk>
+auto make_element_suspension (Thunk &&f, std::true_type)
+{
+  return make_curriable<0>(std::forward<Thunk>(f));
+}
+template<class T, class Thunk>
+auto make_element_suspension (Thunk &&f, std::false_type)
+{
+  return make_curriable<0>([f = typename std::decay<Thunk>::type(std::forward<Thunk>(f))]() -> T {return f();});
+}
+template<class T, class Thunk,
+         typename std::enable_if<!is_list_element_ref<typename std::decay<Thunk>::type>::value, int>::type = 0>
+auto make_element_suspension (Thunk &&f)
+{
+  using result_type = typename std::decay<decltype(std::declval<typename std::decay<Thunk>::type&>()())>::type;
+  return make_element_suspension<T>(std::forward<Thunk>(f), std::is_same<result_type, T>{});
+}
+template<class T, class Thunk,
+         typename std::enable_if<is_list_element_ref<typename std::decay<Thunk>::type>::value, int>::type = 0>
+auto make_element_suspension (Thunk &&f)
+{
+  return typename std::decay<Thunk>::type(std::forward<Thunk>(f));
+}
+
+template<class T, class Thunk>
+using element_suspension_t = decltype(make_element_suspension<T>(std::declval<Thunk>()));
+
+// whether the element suspension S held by an element thunk is unforced
+template<class S>
+struct element_state {
+  template<class ElementThunk>
+  static bool pending (const ElementThunk &thunk)
+  {
+    auto susp = thunk.template target<S>();
+    return susp && !susp->isForced();
+  }
+};
+template<class Node>
+struct element_state<list_element_ref<Node>> {
+  template<class ElementThunk>
+  static bool pending (const ElementThunk&) {return false;}
+};
+
+// a node's memoized link to the next node (owning one reference)
+//
+//  With an atomic refcount the link is published with a CAS: threads that
+//  race to generate the same tail all offer theirs, the first one wins and
+//  the others are dropped. Reading a published link is a single acquire load.
+template<class Node, bool Atomic>
+struct tail_slot {
+  using pointer = intrusive_ptr<const Node>;
+
+  tail_slot () = default;
+  explicit tail_slot (pointer p) noexcept : _p(p.detach()) {}
+  tail_slot (const tail_slot &other) noexcept : _p(pointer(other.get()).detach()) {}
+  tail_slot& operator= (const tail_slot&) = delete;
+  ~tail_slot () {pointer(_p.load(std::memory_order_relaxed), false);}
+
+  const Node* get () const noexcept {return _p.load(std::memory_order_acquire);}
+
+  // the link after offering p (p unless another one was published first)
+  const Node* publish (pointer p) const noexcept
+  {
+    const Node *expected = nullptr;
+    if (!p) return get();
+    if (_p.compare_exchange_strong(expected, p.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return p.detach();
+    }
+    return expected;
+  }
+
+  // unlinks and returns the link (only for the node's last owner)
+  pointer take () const noexcept
+  {
+    auto p = _p.load(std::memory_order_relaxed);
+    _p.store(nullptr, std::memory_order_relaxed);
+    return pointer(p, false);
+  }
+
+  mutable std::atomic<const Node*> _p{nullptr};
+};
+
+template<class Node>
+struct tail_slot<Node, false> {
+  using pointer = intrusive_ptr<const Node>;
+
+  tail_slot () = default;
+  explicit tail_slot (pointer p) noexcept : _p(p.detach()) {}
+  tail_slot (const tail_slot &other) noexcept : _p(pointer(other.get()).detach()) {}
+  tail_slot& operator= (const tail_slot&) = delete;
+  ~tail_slot () {pointer(_p, false);}
+
+  const Node* get () const noexcept {return _p;}
+
+  const Node* publish (pointer p) const noexcept
+  {
+    if (!_p) _p = p.detach();
+    return _p;
+  }
+
+  pointer take () const noexcept
+  {
+    auto p = _p;
+    _p = nullptr;
+    return pointer(p, false);
+  }
+
+  mutable const Node *_p = nullptr;
+};
+
+// keeps a node's allocator (taking no space when it is stateless)
+template<class A>
+struct allocator_holder : private A {
+  allocator_holder () = default;
+  explicit allocator_holder (const A &alloc) : A(alloc) {}
+  const A& get_allocator () const {return *this;}
+};
+
+template<class T, class A = std::allocator<T>, class R = default_refcount>
 struct ListSuspensionManager : 
-  std::enable_shared_from_this<ListSuspensionManager<T>> {
-  using list_generator_type = std::function<List<T>(const List<T>&)>;
-  using thunk_type = std::function<T()>;
+  refcounted<R>, allocator_holder<A> {
+  using allocator_type = A;
+  using node_type = ListSuspensionManager<T, A, R>;
+  using node_pointer = intrusive_ptr<const ListSuspensionManager<T, A, R>>;
+  // inline buffers sized for a value suspension and a small generator closure
+  //  so that neither the element nor the tail generator allocates
+  static constexpr std::size_t thunk_buffer_size = 2*sizeof(T) + 2*sizeof(void*);
+  static constexpr std::size_t generator_buffer_size = 4*sizeof(void*);
+  using list_generator_type = small_function<List<T, A, R>(const List<T, A, R>&), generator_buffer_size>;
+  // (always returns a reference to a value or memo kept in the thunk itself,
+  //  which stays put as long as the node does)
+  using thunk_type = small_function<const T&(), thunk_buffer_size>;
 
   ListSuspensionManager() = delete;
-  ListSuspensionManager(const ListSuspensionManager<T>&) = default;
-  ListSuspensionManager(ListSuspensionManager<T>&&) = default;
+  ListSuspensionManager(const ListSuspensionManager<T, A, R>&) = default;
+  ListSuspensionManager(ListSuspensionManager<T, A, R>&&) = default;
+
+  // (thunks are wrapped in a suspension so each element is evaluated once;
+  //  values are kept as they are)
 
   // next-to-last element
-  ListSuspensionManager(T&& val) : 
-    _thunk(make_suspension_for_value(std::move(val))), 
-    _tail_gen{[](const List<T>&) {return List<T>();}} {}
-  ListSuspensionManager(const T &val) : 
-    _thunk(make_suspension_for_value(val)),
-    _tail_gen{[](const List<T>&) {return List<T>();}} {}
-  ListSuspensionManager(thunk_type f) : 
-    _thunk(f),
-    _tail_gen{[](const List<T>&) {return List<T>();}} {}
-
-  // normal element
-  ListSuspensionManager(T&& val, std::shared_ptr<const ListSuspensionManager<T>> tail) : 
-    _thunk(make_suspension_for_value(std::move(val))), 
-    _tail_gen{[tail](const List<T>&) {return List<T>(tail);}},
-    _tail(tail) {}
-  ListSuspensionManager(const T &val, std::shared_ptr<const ListSuspensionManager<T>> tail) : 
-    _thunk(make_suspension_for_value(val)),
-    _tail_gen{[tail](const List<T>&) {return List<T>(tail);}},
-    _tail(tail) {}
-  ListSuspensionManager(thunk_type f, std::shared_ptr<const ListSuspensionManager<T>> tail) : 
-    _thunk(f),
-    _tail_gen{[tail](const List<T>&) {return List<T>(tail);}},
-    _tail(tail) {}
+  ListSuspensionManager(const A &alloc, T&& val) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_list_value(std::move(val))), 
+    _tail_gen{[](const List<T, A, R> &l) {return List<T, A, R>(l.get_allocator());}} {FCPP_INSTRUMENT_COUNT(list_nodes);}
+  ListSuspensionManager(const A &alloc, const T &val) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_list_value(val)),
+    _tail_gen{[](const List<T, A, R> &l) {return List<T, A, R>(l.get_allocator());}} {FCPP_INSTRUMENT_COUNT(list_nodes);}
+  template<class Thunk, typename std::enable_if<is_list_thunk<Thunk, T>::value, int>::type = 0>
+  ListSuspensionManager(const A &alloc, Thunk &&f) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_element_suspension<T>(std::forward<Thunk>(f))),
+    _tail_gen{[](const List<T, A, R> &l) {return List<T, A, R>(l.get_allocator());}},
+    _pending(&element_state<element_suspension_t<T, Thunk>>::template pending<thunk_type>) {FCPP_INSTRUMENT_COUNT(list_nodes);}
+
+  // normal element (the generator only repeats _tail, so that _tail is the
+  //  one reference to the next node the destructor has to unlink)
+  ListSuspensionManager(const A &alloc, T&& val, node_pointer tail) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_list_value(std::move(val))), 
+    _tail_gen{&_relink},
+    _tail(std::move(tail)) {FCPP_INSTRUMENT_COUNT(list_nodes);}
+  ListSuspensionManager(const A &alloc, const T &val, node_pointer tail) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_list_value(val)),
+    _tail_gen{&_relink},
+    _tail(std::move(tail)) {FCPP_INSTRUMENT_COUNT(list_nodes);}
+  template<class Thunk, typename std::enable_if<is_list_thunk<Thunk, T>::value, int>::type = 0>
+  ListSuspensionManager(const A &alloc, Thunk &&f, node_pointer tail) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_element_suspension<T>(std::forward<Thunk>(f))),
+    _tail_gen{&_relink},
+    _tail(std::move(tail)),
+    _pending(&element_state<element_suspension_t<T, Thunk>>::template pending<thunk_type>) {FCPP_INSTRUMENT_COUNT(list_nodes);}
 
   // generators
-  ListSuspensionManager(T&& val, list_generator_type tail_gen) : 
-    _thunk(make_suspension_for_value(std::move(val))), 
-    _tail_gen{tail_gen} {}
-  ListSuspensionManager(const T &val, list_generator_type tail_gen) : 
-    _thunk(make_suspension_for_value(val)),
-    _tail_gen{tail_gen} {}
-  ListSuspensionManager(thunk_type f, list_generator_type tail_gen) : 
-    _thunk(f),
-    _tail_gen{tail_gen} {}
-
-  bool operator== (const ListSuspensionManager<T> &other) const
+  ListSuspensionManager(const A &alloc, T&& val, list_generator_type tail_gen) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_list_value(std::move(val))), 
+    _tail_gen{std::move(tail_gen)} {FCPP_INSTRUMENT_COUNT(list_nodes);}
+  ListSuspensionManager(const A &alloc, const T &val, list_generator_type tail_gen) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_list_value(val)),
+    _tail_gen{std::move(tail_gen)} {FCPP_INSTRUMENT_COUNT(list_nodes);}
+  template<class Thunk, typename std::enable_if<is_list_thunk<Thunk, T>::value, int>::type = 0>
+  ListSuspensionManager(const A &alloc, Thunk &&f, list_generator_type tail_gen) : 
+    allocator_holder<A>(alloc),
+    _thunk(make_element_suspension<T>(std::forward<Thunk>(f))),
+    _tail_gen{std::move(tail_gen)},
+    _pending(&element_state<element_suspension_t<T, Thunk>>::template pending<thunk_type>) {FCPP_INSTRUMENT_COUNT(list_nodes);}
+
+  // block of count elements at elements (kept alive by the node or its
+  //  tail generator)
+  ListSuspensionManager(const A &alloc, const T *elements, std::size_t count, list_generator_type tail_gen) : 
+    allocator_holder<A>(alloc),
+    _tail_gen{std::move(tail_gen)},
+    _elements(elements),
+    _count(count) {FCPP_INSTRUMENT_COUNT(list_nodes);}
+
+  // releases the nodes only reachable through _tail one at a time, so that
+  //  dropping a long list takes constant stack
+  ~ListSuspensionManager ()
+  {
+    auto next = _tail.take();
+    while (next && next.use_count() == 1)
+      next = next->_tail.take();
+  }
+
+  bool operator== (const ListSuspensionManager<T, A, R> &other) const
   {
     bool are_equal = true;
     if (_thunk && other._thunk) are_equal &= (_thunk() == other._thunk());
     else if ((!_thunk && other._thunk) || (_thunk && !other._thunk)) are_equal &= false;
-    are_equal &= (_tail == other._tail);
+    are_equal &= (_count == other._count && !_elements == !other._elements);
+    for (std::size_t i = 0; are_equal && _elements && i < _count; ++i) are_equal &= (_elements[i] == other._elements[i]);
+    are_equal &= (_tail.get() == other._tail.get());
     if ((!_tail_gen && other._tail_gen) || (_tail_gen && !other._tail_gen)) are_equal &= false;
     return are_equal;
   }
-  bool operator!= (const ListSuspensionManager<T> &other) const {return !(*this == other);}
-  std::shared_ptr<const ListSuspensionManager<T>> get_handle() const {return this->shared_from_this();}
-  const T& operator() () const & {return _thunk();}
-  T operator() () && {return _thunk();}
-  bool is_last_element () const {return !(_tail_gen || _tail);}
+  bool operator!= (const ListSuspensionManager<T, A, R> &other) const {return !(*this == other);}
+  node_pointer get_handle() const {return node_pointer(this);}
+  const T& operator() () const {return (*this)[0];}
+  const T& operator[] (std::size_t i) const {return _elements ? _elements[i] : _thunk();}
+  bool is_last_element () const {return !(_tail_gen || _tail.get());}
+  // whether the element is a suspension that has not been forced yet
+  //  (values, blocks and other nodes' elements never are)
+  bool is_pending () const {return _pending && _pending(_thunk);}
 
   // "private:" stuff
-  void _set_tail (std::shared_ptr<const ListSuspensionManager<T>> tail) const {_tail = tail;}
+  // (the node is destroyed with its last reference)
+  void _release () const noexcept {if (this->_drop_ref()) _destroy(this);}
+  static List<T, A, R> _relink (const List<T, A, R> &l)
+  {
+    auto next = l._head->_tail.get();
+    return next ? List<T, A, R>(node_pointer(next)) : List<T, A, R>(l.get_allocator());
+  }
 
   thunk_type                                              _thunk;
   list_generator_type                                     _tail_gen;
-  mutable std::shared_ptr<const ListSuspensionManager<T>> _tail;
+  tail_slot<ListSuspensionManager<T, A, R>, R::is_atomic> _tail;
+  const T                                                *_elements = nullptr;
+  std::size_t                                             _count = 1;
+  void                                                  (*_destroy)(const ListSuspensionManager<T, A, R>*) = nullptr;
+  bool                                                  (*_pending)(const thunk_type&) = nullptr;
+};
+
+// elements per chunk of a chunked list
+constexpr std::size_t list_chunk_size = 64;
+
+// a block that owns its elements (default constructed, then assigned by fill)
+template<class T, class A, class R>
+struct ListChunk : ListSuspensionManager<T, A, R> {
+  template<class G>
+  ListChunk (const A &alloc, G &fill) : 
+    ListSuspensionManager<T, A, R>(alloc, _values, 0, nullptr)
+  {
+    this->_count = fill(_values, list_chunk_size);
+    // a short chunk means fill is exhausted (the next chunk goes where this
+    //  one went); every chunk keeps fill, which may own what its elements
+    //  refer to (e.g. the file under mapped_lines)
+    if (this->_count == list_chunk_size)
+      this->_tail_gen = [fill](const List<T, A, R> &l) {return make_chunked_list<T, G, A, R>(fill, l._head->get_allocator());};
+    else
+      this->_tail_gen = [fill](const List<T, A, R> &l) {static_cast<void>(fill); return List<T, A, R>(l.get_allocator());};
+  }
+
+  T _values[list_chunk_size];
+};
+
+// a block of elements that live in a buffer outside the list (shared
+//  through owner, or borrowed when owner is empty)
+template<class T, class A, class R>
+struct ListView : ListSuspensionManager<T, A, R> {
+  ListView (const A &alloc, const T *elements, std::size_t count, std::shared_ptr<const void> owner) : 
+    ListSuspensionManager<T, A, R>(alloc, elements, count, [](const List<T, A, R> &l) {return List<T, A, R>(l.get_allocator());}),
+    _owner(std::move(owner)) {}
+
+  std::shared_ptr<const void> _owner;
 };
 
+// element type of a contiguous container (or span)
+template<class C>
+using contiguous_value_t = typename std::remove_const<
+  typename std::remove_pointer<decltype(std::data(std::declval<C&>()))>::type>::type;
+
+// destroys and frees a node made by allocate_node
+template<class Node, class Base>
+void destroy_node (const Base *node) noexcept
+{
+  using traits = typename std::allocator_traits<typename Node::allocator_type>::template rebind_traits<Node>;
+  auto p = static_cast<Node*>(const_cast<Base*>(node));
+  typename traits::allocator_type alloc(p->get_allocator());
+  traits::destroy(alloc, p);
+  traits::deallocate(alloc, p, 1);
+}
+
+// allocates a node (or a chunk) with alloc rebound to its type; the node
+//  is freed the same way when its last reference is dropped
+template<class Node, class A, class ...Args>
+intrusive_ptr<const Node> allocate_node (const A &alloc, Args&& ...args)
+{
+  using traits = typename std::allocator_traits<A>::template rebind_traits<Node>;
+  typename traits::allocator_type node_alloc(alloc);
+  auto p = traits::allocate(node_alloc, 1);
+  try {traits::construct(node_alloc, p, alloc, std::forward<Args>(args)...);}
+  catch (...) {traits::deallocate(node_alloc, p, 1); throw;}
+  p->_destroy = &destroy_node<Node, typename Node::node_type>;
+  return intrusive_ptr<const Node>(p);
+}
+
 }
 
 
 
-template<class T, class A>
-struct List {
-  using list_generator_type = std::function<List<T>(const List<T>&)>;
-  using thunk_type = std::function<T()>;
+// (the allocator is kept like a standard container's, taking no space when
+//  it is stateless, so an empty list still knows where its nodes would go)
+template<class T, class A, class R>
+struct List : _impl::allocator_holder<A> {
+  using node_type = _impl::ListSuspensionManager<T, A, R>;
+  using node_pointer = typename node_type::node_pointer;
+  using allocator_type = A;
+  using refcount_policy = R;
+  using list_generator_type = typename node_type::list_generator_type;
+  using thunk_type = typename node_type::thunk_type;
   // STL compliance
   struct const_iterator;
 
   // copy
-  List (const List<T> &l) = default;
+  List (const List &l) = default;
   // copy assign
-  List& operator=(const List<T> &l) = default;
+  List& operator=(const List &l) = default;
   // move
-  List (List<T>&& l) = default;
+  List (List&& l) = default;
   // move assign
-  List& operator=(List<T>&& l) = default;
+  List& operator=(List&& l) = default;
 
   // empty list
   List() = default;
-  List(NIL_t) : List() {}
+  explicit List (const A &alloc) : 
+    _impl::allocator_holder<A>(alloc) {}
+  // List(NIL_t) : List() {}
 
   // single value lists
-  List (T&& val) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(std::move(val))) {}
-  List (const T &val) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(val)) {}
-  List (thunk_type f) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(f)) {}
-  List (const std::shared_ptr<const _impl::ListSuspensionManager<T>> &m) : 
-    _head(m) {}
-
-  // concat lists
-  List (T&& val, List<T>&& l) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(std::move(val), l._head)) {}
-  List (const T &val, List<T>&& l) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(std::move(val), l._head)) {}
-  List (T&& val, const List<T> &l) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(val, l._head)) {}
-  List (const T &val, const List<T> &l) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(val, l._head)) {}
+  List (T&& val, const A &alloc = A()) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, std::move(val))) {}
+  List (const T &val, const A &alloc = A()) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, val)) {}
+  template<class Thunk, typename std::enable_if<_impl::is_list_thunk<Thunk, T>::value, int>::type = 0>
+  List (Thunk &&f, const A &alloc = A()) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, std::forward<Thunk>(f))) {}
+  // (m is not null)
+  List (const node_pointer &m, std::size_t pos = 0) : 
+    _impl::allocator_holder<A>(m->get_allocator()), _head(m), _pos(pos) {}
+  List (node_pointer &&m, std::size_t pos = 0) : 
+    _impl::allocator_holder<A>(m->get_allocator()), _head(std::move(m)), _pos(pos) {}
+
+  // concat lists (allocated like l unless an allocator is given)
+  List (T&& val, List&& l) : 
+    List(std::move(val), std::move(l), l.get_allocator()) {}
+  List (const T &val, List&& l) : 
+    List(val, std::move(l), l.get_allocator()) {}
+  List (T&& val, const List &l) : 
+    List(std::move(val), l, l.get_allocator()) {}
+  List (const T &val, const List &l) : 
+    List(val, l, l.get_allocator()) {}
+  List (T&& val, List&& l, const A &alloc) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, std::move(val), l._link())) {}
+  List (const T &val, List&& l, const A &alloc) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, std::move(val), l._link())) {}
+  List (T&& val, const List &l, const A &alloc) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, val, l._link())) {}
+  List (const T &val, const List &l, const A &alloc) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, val, l._link())) {}
+
+  template<class Thunk, typename std::enable_if<_impl::is_list_thunk<Thunk, T>::value, int>::type = 0>
+  List (Thunk &&f, const List &l) : 
+    List(std::forward<Thunk>(f), l, l.get_allocator()) {}
+  template<class Thunk, typename std::enable_if<_impl::is_list_thunk<Thunk, T>::value, int>::type = 0>
+  List (Thunk &&f, const List &l, const A &alloc) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, std::forward<Thunk>(f), l._link())) {}
 
   // list generators
-  List (T&& val, list_generator_type f) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(std::move(val), f)) {}
-  List (const T &val, list_generator_type f) : 
-    _head(std::make_shared<const _impl::ListSuspensionManager<T>>(val, f)) {}
-
-  bool operator== (const List &l) const {if (!l._head || !_head) return l._head == _head; return *l._head == *_head;}
+  List (T&& val, list_generator_type f, const A &alloc = A()) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, std::move(val), std::move(f))) {}
+  List (const T &val, list_generator_type f, const A &alloc = A()) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, val, std::move(f))) {}
+  template<class Thunk, typename std::enable_if<_impl::is_list_thunk<Thunk, T>::value, int>::type = 0>
+  List (Thunk &&f, list_generator_type g, const A &alloc = A()) : 
+    _impl::allocator_holder<A>(alloc), _head(_make_node(alloc, std::forward<Thunk>(f), std::move(g))) {}
+
+  bool operator== (const List &l) const {if (!l._head || !_head) return l._head == _head; return l._pos == _pos && *l._head == *_head;}
   bool operator!= (const List &l) const {return !(l == *this);}
 
   const auto& operator() () const & {return *this;}
   auto operator() () && {return std::move(*this);}
-  // const T& head () const &
-  // TODO: fix this!!!
-  T head () const &
+  // (valid as long as the node is, i.e. while any list refers to it)
+  const T& head () const &
   {
-    if (_head) return _head->_thunk();
+    if (_head) return (*_head)[_pos];
     throw("tried to evaluate an empty list");  // TODO: throw for now (possibly use Maybe monad in future)
   }
+  // (a temporary list may hold the last reference to its node)
   T head () &&
   {
-    if (_head) return _head->_thunk();
+    if (_head) return (*_head)[_pos];
     throw("tried to evaluate an empty list");  // TODO: throw for now (possibly use Maybe monad in future)
   }
-  List<T> tail () const
+  List tail () const
   {
     if (_head) {
-      if (_head->is_last_element()) return _head->_tail_gen(*this);
-      if (!_head->_tail && _head->_tail_gen) _head->_set_tail(_head->_tail_gen(*this)._head);
-      return List<T>(_head->_tail);
+      // next element of the same block
+      if (_pos + 1 < _head->_count) return List(_head, _pos + 1);
+      if (_head->is_last_element()) {
+        FCPP_INSTRUMENT_COUNT(list_tails_generated);
+        return _head->_tail_gen(*this);
+      }
+      auto next = _head->_tail.get();
+      if (!next && _head->_tail_gen) {
+        FCPP_INSTRUMENT_COUNT(list_tails_generated);
+        next = _head->_tail.publish(_head->_tail_gen(*this)._link());
+      }
+      else
+        FCPP_INSTRUMENT_COUNT(list_tails_reused);
+      // (an empty tail ends the list)
+      return next ? List(node_pointer(next)) : List(get_allocator());
     }
     throw("tried to evaluate an empty list");  // TODO: throw for now (possibly use Maybe monad in future)
   }
   bool is_empty () const {return static_cast<bool>(_head);}
+  // single pass over the list that memoizes no tail it generates, so the
+  //  nodes behind its cursor are released as it moves on (see FC++14/stream.h)
+  consuming_stream<T, A, R> stream () const;
   list_generator_type get_generator() const {return _head->_tail_gen;}
 
   const_iterator begin() const {return const_iterator{*this};}
   const_iterator cbegin() const {return const_iterator{*this};}
-  const_iterator end() const {return const_iterator{List<T>()};}
-  const_iterator cend() const {return const_iterator{List<T>()};}
+  const_iterator end() const {return const_iterator{List(get_allocator())};}
+  const_iterator cend() const {return const_iterator{List(get_allocator())};}
+
+  A get_allocator () const {return _impl::allocator_holder<A>::get_allocator();}
 
   // "private:" stuff
-  std::shared_ptr<const _impl::ListSuspensionManager<T>> _head;
+  template<class ...Args>
+  static node_pointer _make_node (const A &alloc, Args&& ...args)
+  {
+    return _impl::allocate_node<node_type>(alloc, std::forward<Args>(args)...);
+  }
+
+  // the list after this node's block that leaves a newly generated tail
+  //  unpublished (a tail that is already memoized is still shared)
+  List _unshared_tail () const
+  {
+    if (auto next = _head->_tail.get()) {
+      FCPP_INSTRUMENT_COUNT(list_tails_reused);
+      return List(node_pointer(next));
+    }
+    if (!_head->_tail_gen) return List(get_allocator());
+    FCPP_INSTRUMENT_COUNT(list_tails_generated);
+    return _head->_tail_gen(*this);
+  }
+
+  // a node to link to (the rest of a block is referred to by a new node)
+  node_pointer _link () const
+  {
+    if (_pos == 0) return _head;
+    auto node = _head;
+    auto last = _head->_count - 1;
+    return _make_node(_head->get_allocator(), _head->_elements + _pos, _head->_count - _pos,
+        list_generator_type([node, last](const List&) {return List(node, last).tail();}));
+  }
+
+  node_pointer _head;
+  std::size_t  _pos = 0;
 
   struct const_iterator {
-    typedef typename A::difference_type difference_type;
-    typedef typename A::value_type value_type;
-    typedef typename A::reference const_reference;
-    typedef typename A::pointer const_pointer;
+    typedef typename std::allocator_traits<A>::difference_type difference_type;
+    typedef T value_type;
+    typedef const T& reference;
+    typedef const T* pointer;
+    typedef const T& const_reference;
+    typedef const T* const_pointer;
     typedef std::input_iterator_tag iterator_category;
 
     const_iterator () = default;
@@ -211,24 +582,84 @@ struct List {
     ~const_iterator() {}
 
     const_iterator& operator=(const const_iterator&) = default;
-    bool operator==(const const_iterator &rhs) const {return _element == rhs._element;}
-    bool operator!=(const const_iterator &rhs) const {return _element != rhs._element;}
-
-    const_iterator& operator++() {_element = _element.tail(); return *this;}
-    const_iterator operator++(int) {const_iterator it{_element}; _element = _element.tail(); return it;}
+    bool operator==(const const_iterator &rhs) const {return _element._head == rhs._element._head && _element._pos == rhs._element._pos;}
+    bool operator!=(const const_iterator &rhs) const {return !(*this == rhs);}
+
+    // (within a block only the position moves)
+    const_iterator& operator++()
+    {
+      if (_element._pos + 1 < _element._head->_count) ++_element._pos;
+      else _element = _element.tail();
+      return *this;
+    }
+    const_iterator operator++(int) {const_iterator it{_element}; ++*this; return it;}
 
-    // const T& operator*() const & {return _element.head();}
-    // TODO: fix this!!!
-    T operator*() const & {return _element.head();}
-    T operator*() && {return _element.head();}
-    const T& operator->() const & {return _element.head();}
-    T operator->() && {return _element.head();}
+    // (the element lives in a node, so the reference stays valid after the
+    //  iterator moves on for as long as the list is alive)
+    const T& operator*() const {return _element.head();}
+    const T* operator->() const {return &_element.head();}
 
-    List<T> _element;
+    List _element;
   };
 };
 
 
+
+// lazily generated list whose elements are produced a chunk at a time:
+//  fill(out, n) assigns up to n elements to out and returns how many it
+//  assigned (fewer than n ends the list); fill is copied with its state
+//  into each chunk, so every chunk is generated once from where the
+//  previous one left off (and with the same allocator)
+template<class T, class G, class A, class R>
+List<T, A, R> make_chunked_list (G fill, const A &alloc)
+{
+  auto chunk = _impl::allocate_node<_impl::ListChunk<T, A, R>>(alloc, fill);
+  if (chunk->_count == 0) return List<T, A, R>(alloc);
+  return List<T, A, R>(std::move(chunk));
+}
+
+
+
+// lists over elements already in memory (no copy: head, tail and iteration
+//  step through the buffer in place, and one node covers the whole range)
+//
+//  make_list_view shares ownership of the buffer, so it lives as long as any
+//  list (or tail) of the view. borrow_list_view does not: the caller keeps
+//  the buffer alive and unchanged for as long as any such list exists.
+template<class T, class A = std::allocator<T>, class R = default_refcount>
+List<T, A, R> make_list_view (std::shared_ptr<const void> owner, const T *elements, std::size_t count, const A &alloc = A())
+{
+  if (count == 0) return List<T, A, R>(alloc);
+  return List<T, A, R>(_impl::allocate_node<_impl::ListView<T, A, R>>(alloc, elements, count, std::move(owner)));
+}
+
+template<class C, class T = _impl::contiguous_value_t<C>, class A = std::allocator<T>, class R = default_refcount>
+List<T, A, R> make_list_view (std::shared_ptr<C> c, const A &alloc = A())
+{
+  const T *elements = std::data(*c);
+  auto count = std::size(*c);
+  return make_list_view<T, A, R>(std::move(c), elements, count, alloc);
+}
+
+template<class T, class A = std::allocator<T>, class R = default_refcount>
+List<T, A, R> borrow_list_view (const T *elements, std::size_t count, const A &alloc = A())
+{
+  return make_list_view<T, A, R>(nullptr, elements, count, alloc);
 }
 
+template<class C, class T = _impl::contiguous_value_t<C>, class A = std::allocator<T>, class R = default_refcount>
+List<T, A, R> borrow_list_view (const C &c, const A &alloc = A())
+{
+  return borrow_list_view<T, A, R>(std::data(c), std::size(c), alloc);
+}
+// (a temporary container would be gone before the list)
+template<class C, class T = _impl::contiguous_value_t<C>>
+void borrow_list_view (const C &&c) = delete;
+
+
+}
+
+// (List::stream is defined with the other streams)
+#include "FC++14/stream.h"
+
 #endif
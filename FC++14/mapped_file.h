@@ -0,0 +1,132 @@
+#ifndef FCPP_MAPPED_FILE_H
+#define FCPP_MAPPED_FILE_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FC++14/list.h"
+
+namespace fcpp
+{
+
+// a whole file mapped read-only (POSIX)
+//
+//  The mapping is advised as sequential, and nothing is read until a page
+//  is first touched, so a list over it pages the file in only as far as it
+//  has been traversed. The file must not be truncated while it is mapped.
+struct mapped_file {
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  explicit mapped_file (const std::string &path)
+  {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0) _fail(fd, "fstat " + path);
+    _size = static_cast<std::size_t>(info.st_size);
+    // (an empty file cannot be mapped, and needs no mapping)
+    if (_size > 0) {
+      void *p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) _fail(fd, "mmap " + path);
+      // (only a hint, so failing to give it is no error)
+      ::madvise(p, _size, MADV_SEQUENTIAL);
+      _data = static_cast<const char*>(p);
+    }
+    // (the mapping outlives the descriptor)
+    ::close(fd);
+  }
+
+  ~mapped_file () {if (_data) ::munmap(const_cast<char*>(_data), _size);}
+
+  const char* data () const noexcept {return _data;}
+  std::size_t size () const noexcept {return _size;}
+
+  [[noreturn]] static void _fail (int fd, const std::string &what)
+  {
+    auto error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), what);
+  }
+
+  const char  *_data = nullptr;
+  std::size_t  _size = 0;
+};
+
+
+
+namespace _impl
+{
+
+// fills a chunk with the next lines of a mapped file
+struct mapped_line_fill {
+  std::shared_ptr<const mapped_file> file;
+  std::size_t                        offset;
+
+  std::size_t operator() (std::string_view *out, std::size_t n)
+  {
+    const char *data = file->data();
+    const std::size_t size = file->size();
+    std::size_t i = 0;
+    for (; i < n && offset < size; ++i) {
+      auto begin = data + offset;
+      auto end = static_cast<const char*>(std::memchr(begin, '\n', size - offset));
+      std::size_t length = end ? static_cast<std::size_t>(end - begin) : size - offset;
+      out[i] = std::string_view(begin, length);
+      offset += length + 1;
+    }
+    return i;
+  }
+};
+
+}
+
+
+
+// ///////////////////////////////////////////////////////////////////
+// lazy lists over mapped files (no element is copied out of the file)
+// ///////////////////////////////////////////////////////////////////
+
+// the lines of a file (without their '\n'; a last line without one is
+//  still a line), found a chunk at a time as the list is traversed; the
+//  string_views point into the mapping, which the list keeps alive
+inline List<std::string_view> mapped_lines (std::shared_ptr<const mapped_file> file)
+{
+  return make_chunked_list<std::string_view>(_impl::mapped_line_fill{std::move(file), 0});
+}
+inline List<std::string_view> mapped_lines (const std::string &path)
+{
+  return mapped_lines(std::make_shared<const mapped_file>(path));
+}
+
+// the file as an array of fixed-size records (a trailing partial record is
+//  left out); a view over the mapping, which the list keeps alive
+template<class T>
+List<T> mapped_records (std::shared_ptr<const mapped_file> file)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "records must be trivially copyable");
+  auto records = reinterpret_cast<const T*>(file->data());
+  auto count = file->size()/sizeof(T);
+  return make_list_view<T>(std::move(file), records, count);
+}
+template<class T>
+List<T> mapped_records (const std::string &path)
+{
+  return mapped_records<T>(std::make_shared<const mapped_file>(path));
+}
+
+
+}
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef FCPP_MEMOIZE_H
+#define FCPP_MEMOIZE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "FC++14/functoid.h"
+
+namespace fcpp
+{
+
+// which cached result to drop once a shard is full
+enum class eviction_policy {
+  lru,   // least recently used (every hit reorders the shard)
+  clock  // second chance (a hit only sets a reference bit)
+};
+
+struct memo_options {
+  std::size_t capacity = 4096;  // total number of cached results
+  eviction_policy eviction = eviction_policy::lru;
+  std::size_t shards = 16;      // independently locked partitions
+};
+
+
+
+namespace _impl
+{
+
+template <class T>
+inline void hash_combine (std::size_t &seed, const T &val)
+{
+  seed ^= std::hash<T>()(val) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+template <class Tuple>
+struct tuple_hash {
+  std::size_t operator() (const Tuple &t) const
+  {
+    return hash(t, std::make_index_sequence<std::tuple_size<Tuple>::value>{});
+  }
+
+  template <std::size_t ...I>
+  static std::size_t hash (const Tuple &t, std::index_sequence<I...>)
+  {
+    std::size_t seed = 0;
+    int expand[] = {0, (hash_combine(seed, std::get<I>(t)), 0)...};
+    (void)expand;
+    return seed;
+  }
+};
+
+// bounded map for one shard (callers hold the mutex); slots double as the
+//  LRU list (prev/next) and the clock ring (referenced)
+template <class Key, class R>
+struct memo_shard {
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+  struct slot {
+    Key key;
+    R value;
+    std::size_t prev, next;
+    bool referenced;
+  };
+
+  std::mutex mutex;
+  std::vector<slot> slots;
+  std::unordered_map<Key, std::size_t, tuple_hash<Key>> index;
+  std::size_t newest = npos, oldest = npos;
+  std::size_t hand = 0;
+
+  void unlink (std::size_t i)
+  {
+    auto &s = slots[i];
+    if (s.prev != npos) slots[s.prev].next = s.next; else newest = s.next;
+    if (s.next != npos) slots[s.next].prev = s.prev; else oldest = s.prev;
+  }
+  void push_newest (std::size_t i)
+  {
+    slots[i].prev = npos;
+    slots[i].next = newest;
+    if (newest != npos) slots[newest].prev = i;
+    newest = i;
+    if (oldest == npos) oldest = i;
+  }
+
+  const R* find (const Key &key, eviction_policy eviction)
+  {
+    auto it = index.find(key);
+    if (it == index.end()) return nullptr;
+    auto i = it->second;
+    if (eviction == eviction_policy::lru) {
+      if (i != newest) {unlink(i); push_newest(i);}
+    }
+    else
+      slots[i].referenced = true;
+    return &slots[i].value;
+  }
+
+  std::size_t victim (eviction_policy eviction)
+  {
+    if (eviction == eviction_policy::lru) return oldest;
+    while (slots[hand].referenced) {
+      slots[hand].referenced = false;
+      hand = (hand + 1) % slots.size();
+    }
+    auto i = hand;
+    hand = (hand + 1) % slots.size();
+    return i;
+  }
+
+  void insert (const Key &key, const R &value, std::size_t capacity, eviction_policy eviction)
+  {
+    if (index.find(key) != index.end()) return;  // another thread got here first
+    std::size_t i;
+    if (slots.size() < capacity) {
+      i = slots.size();
+      slots.push_back(slot{key, value, npos, npos, false});
+    }
+    else {
+      i = victim(eviction);
+      index.erase(slots[i].key);
+      if (eviction == eviction_policy::lru) unlink(i);
+      slots[i].key = key;
+      slots[i].value = value;
+      slots[i].referenced = false;
+    }
+    if (eviction == eviction_policy::lru) push_newest(i);
+    index.emplace(key, i);
+  }
+};
+
+struct memo_table_base {
+  virtual ~memo_table_base() = default;
+  const void *tag;
+};
+
+// all cached results for one argument/result signature
+template <class Key, class R>
+struct memo_table : memo_table_base {
+  static const void* type_tag ()
+  {
+    static const char tag = 0;
+    return &tag;
+  }
+
+  explicit memo_table (const memo_options &options) :
+    capacity(shard_capacity(options)),
+    eviction(options.eviction),
+    shards(shard_count(options))
+  {
+    this->tag = type_tag();
+  }
+
+  // (at least one shard, holding at least one result)
+  static std::size_t shard_count (const memo_options &options) {return options.shards > 0 ? options.shards : 1;}
+  static std::size_t shard_capacity (const memo_options &options)
+  {
+    const auto count = shard_count(options);
+    const auto per_shard = options.capacity/count + (options.capacity % count != 0);
+    return per_shard > 0 ? per_shard : 1;
+  }
+
+  // the result is computed outside of any lock
+  template <class Compute>
+  R get_or_compute (const Key &key, Compute &&compute)
+  {
+    auto &shard = shards[tuple_hash<Key>()(key) % shards.size()];
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      if (auto found = shard.find(key, eviction)) {
+        FCPP_INSTRUMENT_COUNT(memo_hits);
+        return *found;
+      }
+    }
+    FCPP_INSTRUMENT_COUNT(memo_misses);
+    R value = compute();
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.insert(key, value, capacity, eviction);
+    }
+    return value;
+  }
+
+  std::size_t capacity;
+  eviction_policy eviction;
+  std::vector<memo_shard<Key, R>> shards;
+};
+
+// a generic function may be called with several signatures, each getting its
+//  own table (found without locking)
+struct memo_tables {
+  static constexpr std::size_t max_signatures = 8;
+
+  memo_tables() = delete;
+  memo_tables(const memo_tables&) = delete;
+  explicit memo_tables (const memo_options &o) : options(o)
+  {
+    for (auto &table : tables) table.store(nullptr, std::memory_order_relaxed);
+  }
+  ~memo_tables ()
+  {
+    for (auto &table : tables) delete table.load(std::memory_order_relaxed);
+  }
+
+  // nullptr if every signature slot is taken
+  template <class Key, class R>
+  memo_table<Key, R>* get ()
+  {
+    const void *tag = memo_table<Key, R>::type_tag();
+    for (auto &table : tables) {
+      auto p = table.load(std::memory_order_acquire);
+      if (!p) {
+        auto fresh = new memo_table<Key, R>(options);
+        if (table.compare_exchange_strong(p, fresh, std::memory_order_acq_rel)) return fresh;
+        delete fresh;
+      }
+      if (p->tag == tag) return static_cast<memo_table<Key, R>*>(p);
+    }
+    return nullptr;
+  }
+
+  memo_options options;
+  std::atomic<memo_table_base*> tables[max_signatures];
+};
+
+template <class F>
+struct memoized {
+  F f;
+  std::shared_ptr<memo_tables> tables;
+
+  template <class ...Args>
+  auto operator() (Args&& ...args) const
+  {
+    using key_type = std::tuple<typename std::decay<Args>::type...>;
+    using result_type = typename std::decay<decltype(f(std::forward<Args>(args)...))>::type;
+    auto table = tables->template get<key_type, result_type>();
+    if (!table) return result_type(f(std::forward<Args>(args)...));
+    key_type key(args...);
+    return table->get_or_compute(key, [&]() {return result_type(f(std::forward<Args>(args)...));});
+  }
+};
+
+}
+
+
+
+// ////////////////////////////////////////////////////////////////////////
+// curriable functoid caching fully applied results (copies, partial
+//  applications and compositions all share one bounded, sharded cache)
+// ////////////////////////////////////////////////////////////////////////
+template <int N, class F>
+auto make_memoized (F &&f, const memo_options &options = memo_options())
+{
+  _impl::memoized<typename std::decay<F>::type> m{
+    std::forward<F>(f), std::make_shared<_impl::memo_tables>(options)};
+  return make_curriable<N>(std::move(m));
+}
+
+}
+
+#endif
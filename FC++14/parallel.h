@@ -0,0 +1,97 @@
+#ifndef FCPP_PARALLEL_H
+#define FCPP_PARALLEL_H
+
+#include <cstddef>
+#include <utility>
+
+#include "FC++14/functoid.h"
+#include "FC++14/list.h"
+#include "FC++14/thread_pool.h"
+
+// elements are forced on worker threads while the consumer reads them
+#if !defined(FCPP_TREADSAFE_SUSP)
+#error "FC++14/parallel.h requires FCPP_TREADSAFE_SUSP"
+#endif
+
+namespace fcpp
+{
+
+// ////////////////////////////////////////////////////////////////////////
+// evaluation strategies for List<T>
+//
+//  Only element thunks are forced on the pool; the spine (tail generation
+//  and its memoization) is always walked on the calling thread.
+//  A spark that does not fit in the pool is dropped, leaving that element
+//  to be forced by the consumer as usual.
+// ////////////////////////////////////////////////////////////////////////
+
+namespace _impl
+{
+
+template <class T, class A, class R>
+void spark_head (const List<T, A, R> &l, thread_pool &pool)
+{
+  static_assert(R::is_atomic, "lists evaluated in parallel need an atomic_refcount");
+  auto node = l._head;
+  // (values, blocks and forced elements have nothing left to evaluate)
+  if (node && node->is_pending()) pool.try_submit([node]() {node->_thunk();});
+}
+
+// mirrors cur (each element refers to cur's, so nothing is copied); every
+//  element up to ahead has been sparked
+template <class T, class A, class R>
+List<T, A, R> par_buffer_from (List<T, A, R> cur, List<T, A, R> ahead, thread_pool &pool)
+{
+  using list_t = List<T, A, R>;
+  if (!cur._head) return list_t(cur.get_allocator());
+  return list_t(list_element_ref<typename list_t::node_type>{cur._head, cur._pos},
+      typename list_t::list_generator_type([cur, ahead, &pool](const list_t&)
+        {
+          auto next_ahead = ahead._head ? ahead.tail() : ahead;
+          spark_head(next_ahead, pool);
+          return par_buffer_from(cur.tail(), next_ahead, pool);
+        }),
+      cur.get_allocator());
+}
+
+}
+
+
+
+// sparks every element of a (finite) list and returns it
+template <class T, class A, class R>
+List<T, A, R> par_list (const List<T, A, R> &l, thread_pool &pool = default_thread_pool())
+{
+  for (List<T, A, R> cur = l; cur._head; cur = cur.tail())
+    _impl::spark_head(cur, pool);
+  return l;
+}
+
+// lazily mirrors a (possibly infinite) list, keeping k elements in flight
+//  ahead of the consumer
+template <class T, class A, class R>
+List<T, A, R> par_buffer (std::size_t k, const List<T, A, R> &l, thread_pool &pool = default_thread_pool())
+{
+  if (k == 0 || !l._head) return l;
+  // ahead is the last element sparked so far
+  List<T, A, R> ahead = l;
+  _impl::spark_head(ahead, pool);
+  for (std::size_t i = 1; i < k && ahead._head; ++i) {
+    ahead = ahead.tail();
+    _impl::spark_head(ahead, pool);
+  }
+  return _impl::par_buffer_from(l, ahead, pool);
+}
+
+
+
+// curried versions (on the default thread pool)
+auto parList = make_curriable<1>([](auto&& l)
+    {return par_list(l());});
+
+auto parBuffer = make_curriable<2>([](auto&& k, auto&& l)
+    {return par_buffer(static_cast<std::size_t>(k), l());});
+
+}
+
+#endif
@@ -4,9 +4,11 @@
 #include <utility>
 #include <type_traits>
 #include <functional>
+#include <cstddef>
 
 #include "FC++14/functoid.h"
 #include "FC++14/list.h"
+#include "FC++14/stream.h"
 
 namespace fcpp
 {
@@ -26,35 +28,62 @@ auto cons = make_curriable<2>([](auto&& val, auto&& c)
 
 // works with any functor container with method "head"
 auto head = make_curriable<1>([](auto&& c) 
-    {if (!nil(std::forward<decltype(c)>(c))()) return c().head();
+    {if (!nil(c)()) return c().head();
     throw("empty container");}); // TODO: throw for now
 
 // works with any functor container with method "tail"
 auto tail = make_curriable<1>([](auto&& c) 
-    {if (!nil(std::forward<decltype(c)>(c))()) return c().tail();
+    {if (!nil(c)()) return c().tail();
     throw("empty container");}); // TODO: throw for now
 
 // //////////////////
 // List<T> generators
 // //////////////////
 
-// uses List<T>'s generator constructors to make a list from the first two elements in an arithmetic series
-auto enumFrom = make_curriable<2>([](auto&& x1, auto&& x2)
-    {using list_t = List<typename std::decay<decltype(x1)>::type>;
-    // lambda in lambda technique
-    auto func = [diff = x2 - x1](const list_t& l) 
-    {return list_t(l.head()+diff, l.get_generator());};
-    return list_t(std::forward<decltype(x1)>(x1), func);});
-
-// uses List<T>'s generator constructors to make a list from the first two elements in an arithmetic series up to the last element
-auto enumFromTo = make_curriable<3>([](auto&& x1, auto&& x2, auto&& xn)
-    {using list_t = List<typename std::decay<decltype(x1)>::type>;
-    // lambda in lambda technique
-    auto func = [diff = x2 - x1, xn](const list_t& l) 
-    {auto next_val = l.head()+diff;
-    if (next_val <= xn) return list_t(l.head()+diff, l.get_generator());
-    return list_t();};
-    return list_t(std::forward<decltype(x1)>(x1), func);});
+// makes a chunked list from the first two elements in an arithmetic series
+auto enumFrom = make_curriable<2>(_impl::make_stream_producer([](auto&& x1, auto&& x2)
+    {using value_t = typename std::decay<decltype(x1)>::type;
+    return enum_from_stream<value_t>(x1, x2 - x1);}));
+
+// makes a chunked list from the first two elements in an arithmetic series up to the last element
+//  (the first element is always part of the list)
+auto enumFromTo = make_curriable<3>(_impl::make_stream_producer([](auto&& x1, auto&& x2, auto&& xn)
+    {using value_t = typename std::decay<decltype(x1)>::type;
+    return enum_from_to_stream<value_t>(x1, x2 - x1, xn);}));
+
+// ////////////////////////////////////////////////////////////
+// List<T> functions (fused: see FC++14/stream.h)
+//
+//  These take a List or a stream and give a stream, which can
+//  be iterated or converted to a List; composed with * they
+//  run as one loop, e.g. foldl(f, z) * map(g) * enumFromTo(1, 2, n)
+//  builds no List at all.
+// ////////////////////////////////////////////////////////////
+
+auto map = make_curriable<2>(_impl::make_stream_consumer([](auto&& f, auto&& c)
+    {auto in = stream_of(c());
+    return map_stream<decltype(in), typename std::decay<decltype(f)>::type>(std::move(in), f);}));
+
+auto filter = make_curriable<2>(_impl::make_stream_consumer([](auto&& p, auto&& c)
+    {auto in = stream_of(c());
+    return filter_stream<decltype(in), typename std::decay<decltype(p)>::type>(std::move(in), p);}));
+
+auto take = make_curriable<2>(_impl::make_stream_consumer([](std::size_t n, auto&& c)
+    {auto in = stream_of(c());
+    return take_stream<decltype(in)>(n, std::move(in));}));
+
+auto drop = make_curriable<2>(_impl::make_stream_consumer([](std::size_t n, auto&& c)
+    {auto in = stream_of(c());
+    return drop_stream<decltype(in)>(n, std::move(in));}));
+
+auto zipWith = make_curriable<3>(_impl::make_stream_consumer([](auto&& f, auto&& c1, auto&& c2)
+    {auto in1 = stream_of(c1());
+    auto in2 = stream_of(c2());
+    return zip_with_stream<decltype(in1), decltype(in2), typename std::decay<decltype(f)>::type>(std::move(in1), std::move(in2), f);}));
+
+// strict left fold (Haskell's foldl'); the result has the type of z
+auto foldl = make_curriable<3>(_impl::make_stream_consumer([](auto&& f, auto&& z, auto&& c)
+    {return fold_stream(f, typename std::decay<decltype(z)>::type(z), stream_of(c()));}));
 
 }
 
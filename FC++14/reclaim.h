@@ -0,0 +1,136 @@
+#ifndef FCPP_RECLAIM_H
+#define FCPP_RECLAIM_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "FC++14/list.h"
+
+namespace fcpp
+{
+
+// deferred release of lists
+//
+//  defer(l) takes over the reference l holds and returns at once; whatever
+//  only l kept alive is destroyed later, either on the helper thread or by
+//  whoever calls drain() (for a reclaimer made without one). A thread that
+//  must not pause can so drop a long list without freeing its nodes.
+//  Nodes are freed on another thread than the one that allocated them, so
+//  only lists with an atomic_refcount can be deferred, and lists allocated
+//  in a monotonic_arena must not be deferred past the arena's lifetime
+//  (pool_allocator hands such nodes back to the allocating thread's pool).
+struct list_reclaimer {
+  list_reclaimer(const list_reclaimer&) = delete;
+  list_reclaimer& operator=(const list_reclaimer&) = delete;
+
+  explicit list_reclaimer (bool background = true)
+  {
+    if (background) _helper = std::thread([this]() {this->_run();});
+  }
+
+  // releases everything still queued before joining
+  ~list_reclaimer ()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_one();
+    if (_helper.joinable()) _helper.join();
+    drain();
+  }
+
+  template<class T, class A, class R>
+  void defer (List<T, A, R> &&l)
+  {
+    static_assert(R::is_atomic, "deferred lists need an atomic_refcount");
+    using node_type = typename List<T, A, R>::node_type;
+    if (!l._head) return;
+    bool was_empty;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      was_empty = _queue.empty();
+      _queue.push_back(held_node{l._head.get(), &_release_node<node_type>});
+    }
+    // (the reference now belongs to the queue)
+    l._head.detach();
+    if (was_empty) _wake.notify_one();
+  }
+
+  // releases the queued lists on the calling thread
+  void drain ()
+  {
+    std::vector<held_node> batch;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      batch.swap(_queue);
+    }
+    _release_all(batch);
+  }
+
+  std::size_t pending () const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+  }
+
+  // "private:" stuff
+  // a type erased reference to a list node
+  struct held_node {
+    const void *node;
+    void (*release)(const void*);
+  };
+
+  template<class Node>
+  static void _release_node (const void *node) {static_cast<const Node*>(node)->_release();}
+
+  static void _release_all (std::vector<held_node> &batch)
+  {
+    for (auto &h : batch) h.release(h.node);
+    batch.clear();
+  }
+
+  void _run ()
+  {
+    std::vector<held_node> batch;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.wait(lock, [this]() {return _stop || !_queue.empty();});
+        if (_queue.empty()) return;
+        batch.swap(_queue);
+      }
+      // (outside the lock, so defer never waits for a release)
+      _release_all(batch);
+    }
+  }
+
+  mutable std::mutex                       _mutex;
+  std::condition_variable                  _wake;
+  std::vector<held_node>                   _queue;
+  std::thread                              _helper;
+  bool                                     _stop = false;
+};
+
+
+
+// reclaimer used when none is given explicitly
+inline list_reclaimer& default_list_reclaimer ()
+{
+  static list_reclaimer reclaimer;
+  return reclaimer;
+}
+
+template<class T, class A, class R>
+void release_later (List<T, A, R> &&l, list_reclaimer &reclaimer = default_list_reclaimer())
+{
+  reclaimer.defer(std::move(l));
+}
+
+}
+
+#endif
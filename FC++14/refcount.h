@@ -0,0 +1,146 @@
+#ifndef FCPP_REFCOUNT_H
+#define FCPP_REFCOUNT_H
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// (glibc tells whether the process has ever started a second thread)
+#if defined(__has_include)
+#if __has_include(<sys/single_threaded.h>)
+#include <sys/single_threaded.h>
+#define FCPP_SINGLE_THREADED() (__libc_single_threaded != 0)
+#endif
+#endif
+#if !defined(FCPP_SINGLE_THREADED)
+#define FCPP_SINGLE_THREADED() false
+#endif
+
+namespace fcpp
+{
+
+// ////////////////////////////////////////////////////////////////////////
+// intrusive reference counting
+//
+//  The count lives in the object (deriving from refcounted<Policy>), so
+//  there is no separate control block and copying a pointer is a single
+//  increment. The policy picks how the count is kept:
+//
+//  atomic_refcount    objects may be shared between threads
+//  local_refcount     plain counter, for objects used by a single thread
+//
+//  Like std::shared_ptr, atomic_refcount uses plain loads and stores while
+//  the process has never started a second thread (where the C library can
+//  tell).
+//
+//  default_refcount is atomic_refcount when suspensions are thread safe
+//  (FCPP_TREADSAFE_SUSP) and local_refcount otherwise.
+// ////////////////////////////////////////////////////////////////////////
+
+struct atomic_refcount {
+  using count_type = std::atomic<std::size_t>;
+  static constexpr bool is_atomic = true;
+
+  static void increment (count_type &c) noexcept
+  {
+    if (FCPP_SINGLE_THREADED()) c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    else c.fetch_add(1, std::memory_order_relaxed);
+  }
+  // true when the last reference was dropped
+  static bool decrement (count_type &c) noexcept
+  {
+    if (FCPP_SINGLE_THREADED()) {
+      auto n = c.load(std::memory_order_relaxed) - 1;
+      c.store(n, std::memory_order_relaxed);
+      return n == 0;
+    }
+    return c.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+  static std::size_t load (const count_type &c) noexcept {return c.load(std::memory_order_acquire);}
+};
+
+struct local_refcount {
+  using count_type = std::size_t;
+  static constexpr bool is_atomic = false;
+
+  static void increment (count_type &c) noexcept {++c;}
+  static bool decrement (count_type &c) noexcept {return --c == 0;}
+  static std::size_t load (const count_type &c) noexcept {return c;}
+};
+
+#if defined(FCPP_TREADSAFE_SUSP)
+using default_refcount = atomic_refcount;
+#else
+using default_refcount = local_refcount;
+#endif
+
+
+
+// base holding the count (a copy starts out unreferenced)
+template<class Policy>
+struct refcounted {
+  using refcount_policy = Policy;
+
+  refcounted () noexcept = default;
+  refcounted (const refcounted&) noexcept {}
+  refcounted& operator= (const refcounted&) noexcept {return *this;}
+
+  std::size_t use_count () const noexcept {return Policy::load(_refs);}
+
+  // "private:" stuff
+  void _add_ref () const noexcept {Policy::increment(_refs);}
+  bool _drop_ref () const noexcept {return Policy::decrement(_refs);}
+
+  mutable typename Policy::count_type _refs{0};
+};
+
+// pointer to an object with an embedded count; T provides _add_ref() and
+//  _release() (which drops a reference and destroys the object with the last)
+template<class T>
+struct intrusive_ptr {
+  using element_type = T;
+
+  constexpr intrusive_ptr () noexcept = default;
+  constexpr intrusive_ptr (std::nullptr_t) noexcept {}
+  // (add_ref == false adopts a reference the caller already owns)
+  explicit intrusive_ptr (T *p, bool add_ref = true) noexcept : _p(p) {if (_p && add_ref) _p->_add_ref();}
+  intrusive_ptr (const intrusive_ptr &other) noexcept : _p(other._p) {if (_p) _p->_add_ref();}
+  intrusive_ptr (intrusive_ptr &&other) noexcept : _p(other._p) {other._p = nullptr;}
+  template<class U, typename std::enable_if<std::is_convertible<U*, T*>::value, int>::type = 0>
+  intrusive_ptr (const intrusive_ptr<U> &other) noexcept : _p(other._p) {if (_p) _p->_add_ref();}
+  template<class U, typename std::enable_if<std::is_convertible<U*, T*>::value, int>::type = 0>
+  intrusive_ptr (intrusive_ptr<U> &&other) noexcept : _p(other._p) {other._p = nullptr;}
+  ~intrusive_ptr () {if (_p) _p->_release();}
+
+  // (by value, so self assignment and assigning a pointer owned by the
+  //  object released are both safe)
+  intrusive_ptr& operator= (intrusive_ptr other) noexcept {swap(other); return *this;}
+
+  void swap (intrusive_ptr &other) noexcept {std::swap(_p, other._p);}
+  void reset () noexcept {intrusive_ptr().swap(*this);}
+  // gives up the reference without dropping it
+  T* detach () noexcept {auto p = _p; _p = nullptr; return p;}
+
+  T* get () const noexcept {return _p;}
+  T& operator* () const noexcept {return *_p;}
+  T* operator-> () const noexcept {return _p;}
+  explicit operator bool () const noexcept {return _p != nullptr;}
+  std::size_t use_count () const noexcept {return _p ? _p->use_count() : 0;}
+
+  // "private:" stuff
+  T *_p = nullptr;
+};
+
+template<class T, class U>
+bool operator== (const intrusive_ptr<T> &a, const intrusive_ptr<U> &b) {return a.get() == b.get();}
+template<class T, class U>
+bool operator!= (const intrusive_ptr<T> &a, const intrusive_ptr<U> &b) {return a.get() != b.get();}
+template<class T>
+bool operator== (const intrusive_ptr<T> &a, std::nullptr_t) {return !a;}
+template<class T>
+bool operator!= (const intrusive_ptr<T> &a, std::nullptr_t) {return static_cast<bool>(a);}
+
+}
+
+#endif
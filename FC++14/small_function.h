@@ -0,0 +1,188 @@
+#ifndef FCPP_SMALL_FUNCTION_H
+#define FCPP_SMALL_FUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fcpp
+{
+
+// type-erased callable (like std::function) that keeps any callable of at
+//  most Size bytes in an inline buffer, so small closures never touch the
+//  heap; larger ones fall back to a heap allocation
+//
+//  With Copyable == false the wrapper is move-only and accepts move-only
+//  callables (copying it is a compile-time error).
+template <class Sig, std::size_t Size = 4*sizeof(void*), bool Copyable = true>
+struct small_function;
+
+template <class R, class ...Args, std::size_t Size, bool Copyable>
+struct small_function<R(Args...), Size, Copyable> {
+  using result_type = R;
+  static constexpr std::size_t buffer_size = Size < sizeof(void*) ? sizeof(void*) : Size;
+
+  small_function () noexcept : _ops(nullptr) {}
+  small_function (std::nullptr_t) noexcept : _ops(nullptr) {}
+
+  template <class F,
+            class D = typename std::decay<F>::type,
+            typename std::enable_if<!std::is_same<D, small_function>::value, int>::type = 0,
+            typename std::enable_if<std::is_convertible<decltype(std::declval<D&>()(std::declval<Args>()...)), R>::value ||
+                                    std::is_void<R>::value, int>::type = 0>
+  small_function (F &&f) : _ops(nullptr)
+  {
+    static_assert(!Copyable || std::is_copy_constructible<D>::value,
+        "a copyable small_function needs a copy-constructible callable");
+    static_assert(binds_result<decltype(std::declval<D&>()(std::declval<Args>()...))>::value,
+        "a small_function returning a reference needs a callable that returns one (not a temporary)");
+    _emplace<D>(std::forward<F>(f), std::integral_constant<bool, stored_inline<D>::value>{});
+  }
+
+  small_function (small_function &&other) noexcept : _ops(other._ops)
+  {
+    if (_ops) {
+      _ops->move(&_buffer, &other._buffer);
+      other._ops = nullptr;
+    }
+  }
+  small_function (const small_function &other) : _ops(other._ops)
+  {
+    static_assert(Copyable, "move-only small_function cannot be copied");
+    if (_ops) _ops->copy(&_buffer, &other._buffer);
+  }
+
+  ~small_function () {_reset();}
+
+  small_function& operator= (small_function &&other) noexcept
+  {
+    if (this != &other) {
+      _reset();
+      if (other._ops) {
+        other._ops->move(&_buffer, &other._buffer);
+        _ops = other._ops;
+        other._ops = nullptr;
+      }
+    }
+    return *this;
+  }
+  small_function& operator= (const small_function &other)
+  {
+    if (this != &other) {
+      small_function temp(other);
+      *this = std::move(temp);
+    }
+    return *this;
+  }
+  small_function& operator= (std::nullptr_t) noexcept
+  {
+    _reset();
+    return *this;
+  }
+
+  explicit operator bool () const noexcept {return _ops != nullptr;}
+
+  // the stored callable if it is a D (like std::function::target)
+  template <class D>
+  const D* target () const noexcept {return _target<D>(std::integral_constant<bool, stored_inline<D>::value>{});}
+
+  // like std::function, the target is invoked as a (non-const) lvalue
+  R operator() (Args ...args) const
+  {
+    if (!_ops) throw std::bad_function_call();
+    return _ops->invoke(const_cast<void*>(static_cast<const void*>(&_buffer)), std::forward<Args>(args)...);
+  }
+
+  // "private:" stuff
+  // whether R can refer to a Res without binding to a temporary
+  template <class Res>
+  struct binds_result : std::integral_constant<bool, !std::is_reference<R>::value ||
+    (std::is_reference<Res>::value &&
+     (std::is_same<typename std::decay<Res>::type, typename std::decay<R>::type>::value ||
+      std::is_base_of<typename std::decay<R>::type, typename std::decay<Res>::type>::value))> {};
+
+  struct ops_type {
+    R (*invoke) (void*, Args&&...);
+    void (*move) (void*, void*);     // move-construct into dst, destroy src
+    void (*copy) (void*, const void*);
+    void (*destroy) (void*);
+  };
+
+  template <class D>
+  struct stored_inline : std::integral_constant<bool,
+    sizeof(D) <= buffer_size && alignof(std::max_align_t) % alignof(D) == 0 &&
+    std::is_nothrow_move_constructible<D>::value> {};
+
+  template <class D>
+  static void _copy_inline (void *dst, const void *src, std::true_type)
+  {new(dst) D(*static_cast<const D*>(src));}
+  template <class D>
+  static void _copy_inline (void*, const void*, std::false_type) {}
+  template <class D>
+  static void _copy_heap (void *dst, const void *src, std::true_type)
+  {*static_cast<D**>(dst) = new D(**static_cast<D* const*>(src));}
+  template <class D>
+  static void _copy_heap (void*, const void*, std::false_type) {}
+
+  template <class D>
+  static const ops_type* _inline_ops ()
+  {
+    static const ops_type ops{
+      [](void *p, Args&& ...args) -> R {return (*static_cast<D*>(p))(std::forward<Args>(args)...);},
+      [](void *dst, void *src) {new(dst) D(std::move(*static_cast<D*>(src))); static_cast<D*>(src)->~D();},
+      [](void *dst, const void *src) {_copy_inline<D>(dst, src, std::integral_constant<bool, Copyable>{});},
+      [](void *p) {static_cast<D*>(p)->~D();}};
+    return &ops;
+  }
+  template <class D>
+  static const ops_type* _heap_ops ()
+  {
+    static const ops_type ops{
+      [](void *p, Args&& ...args) -> R {return (**static_cast<D**>(p))(std::forward<Args>(args)...);},
+      [](void *dst, void *src) {*static_cast<D**>(dst) = *static_cast<D**>(src);},
+      [](void *dst, const void *src) {_copy_heap<D>(dst, src, std::integral_constant<bool, Copyable>{});},
+      [](void *p) {delete *static_cast<D**>(p);}};
+    return &ops;
+  }
+
+  template <class D, class F>
+  void _emplace (F &&f, std::true_type)
+  {
+    new(&_buffer) D(std::forward<F>(f));
+    _ops = _inline_ops<D>();
+  }
+  template <class D, class F>
+  void _emplace (F &&f, std::false_type)
+  {
+    *reinterpret_cast<D**>(&_buffer) = new D(std::forward<F>(f));
+    _ops = _heap_ops<D>();
+  }
+
+  template <class D>
+  const D* _target (std::true_type) const noexcept
+  {
+    return _ops == _inline_ops<D>() ? static_cast<const D*>(static_cast<const void*>(&_buffer)) : nullptr;
+  }
+  template <class D>
+  const D* _target (std::false_type) const noexcept
+  {
+    return _ops == _heap_ops<D>() ? *static_cast<D* const*>(static_cast<const void*>(&_buffer)) : nullptr;
+  }
+
+  void _reset () noexcept
+  {
+    if (_ops) {
+      _ops->destroy(&_buffer);
+      _ops = nullptr;
+    }
+  }
+
+  const ops_type *_ops;
+  typename std::aligned_storage<buffer_size, alignof(std::max_align_t)>::type _buffer;
+};
+
+}
+
+#endif
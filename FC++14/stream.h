@@ -0,0 +1,445 @@
+#ifndef FCPP_STREAM_H
+#define FCPP_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+#include "FC++14/functoid.h"
+#include "FC++14/list.h"
+
+namespace fcpp
+{
+
+// ////////////////////////////////////////////////////////////////////////
+// fusible streams (unfolds with skip states)
+//
+//  A stream is a small copyable value that holds its own state; next(out)
+//  advances it by one step, which either yields an element (assigned to
+//  out), skips (input was consumed without producing an element, e.g. a
+//  filtered out element) or finds the stream done. No step loops or
+//  recurses, so a chain of stream combinators inlines into the single loop
+//  of whatever consumes it and no List node is built between the stages.
+//
+//  Elements are default constructed before they are assigned (as in a
+//  chunk of a List); out is only meaningful after a yield.
+// ////////////////////////////////////////////////////////////////////////
+enum class stream_step {done, skip, yield};
+
+// the end of any stream's iteration
+struct stream_sentinel {};
+
+template <class Derived, class T>
+struct stream_base {
+  using value_type = T;
+  struct const_iterator;
+
+  // (a stream is its own functor container)
+  const Derived& operator() () const & {return derived();}
+  Derived operator() () && {return std::move(derived());}
+
+  // single pass over a copy of the stream
+  const_iterator begin () const {return const_iterator(derived());}
+  stream_sentinel end () const {return stream_sentinel();}
+
+  // the remaining elements as a lazily generated (chunked) List
+  template <class A = std::allocator<T>, class R = default_refcount>
+  List<T, A, R> to_list (const A &alloc = A()) const;
+  template <class A, class R>
+  operator List<T, A, R> () const {return to_list<A, R>();}
+
+  const Derived& derived () const {return static_cast<const Derived&>(*this);}
+  Derived& derived () {return static_cast<Derived&>(*this);}
+
+  struct const_iterator {
+    typedef std::ptrdiff_t difference_type;
+    typedef T value_type;
+    typedef const T& reference;
+    typedef const T* pointer;
+    typedef std::input_iterator_tag iterator_category;
+
+    explicit const_iterator (const Derived &s) : _stream(s) {++*this;}
+
+    bool operator== (stream_sentinel) const {return _done;}
+    bool operator!= (stream_sentinel) const {return !_done;}
+
+    const_iterator& operator++ ()
+    {
+      stream_step step;
+      while ((step = _stream.next(_value)) == stream_step::skip) {}
+      _done = (step == stream_step::done);
+      return *this;
+    }
+
+    const T& operator* () const {return _value;}
+    const T* operator-> () const {return &_value;}
+
+    Derived _stream;
+    T       _value{};
+    bool    _done = false;
+  };
+};
+
+
+
+namespace _impl
+{
+
+// fills List chunks from a stream
+template <class S>
+struct stream_fill {
+  S s;
+
+  std::size_t operator() (typename S::value_type *out, std::size_t n)
+  {
+    std::size_t i = 0;
+    while (i < n) {
+      auto step = s.next(out[i]);
+      if (step == stream_step::done) break;
+      if (step == stream_step::yield) ++i;
+    }
+    return i;
+  }
+};
+
+}
+
+template <class Derived, class T>
+template <class A, class R>
+List<T, A, R> stream_base<Derived, T>::to_list (const A &alloc) const
+{
+  return make_chunked_list<T, _impl::stream_fill<Derived>, A, R>(_impl::stream_fill<Derived>{derived()}, alloc);
+}
+
+
+
+// //////////////
+// stream sources
+// //////////////
+
+// the elements of a List
+template <class T, class A, class R>
+struct list_stream : stream_base<list_stream<T, A, R>, T> {
+  explicit list_stream (const List<T, A, R> &l) : _it(l.begin()), _end(l.end()) {}
+
+  stream_step next (T &out)
+  {
+    if (_it == _end) return stream_step::done;
+    out = *_it;
+    ++_it;
+    return stream_step::yield;
+  }
+
+  typename List<T, A, R>::const_iterator _it, _end;
+};
+
+// the elements of a List, walked without memoizing the tails it generates:
+//  neither the list it started from nor the stream itself keeps the nodes
+//  behind the cursor alive, so one pass over a long (or infinite) generated
+//  list runs in constant memory (another pass generates those tails again)
+template <class T, class A, class R>
+struct consuming_stream : stream_base<consuming_stream<T, A, R>, T> {
+  explicit consuming_stream (const List<T, A, R> &l) : _rest(l) {}
+
+  stream_step next (T &out)
+  {
+    if (!_rest._head) return stream_step::done;
+    out = _rest.head();
+    // (within a block only the position moves)
+    if (_rest._pos + 1 < _rest._head->_count) ++_rest._pos;
+    else _rest = _rest._unshared_tail();
+    return stream_step::yield;
+  }
+
+  List<T, A, R> _rest;
+};
+
+template <class T, class A, class R>
+consuming_stream<T, A, R> List<T, A, R>::stream () const {return consuming_stream<T, A, R>(*this);}
+
+// x1, x1 + diff, x1 + 2*diff, ...
+template <class T>
+struct enum_from_stream : stream_base<enum_from_stream<T>, T> {
+  enum_from_stream (T x1, T diff) : _next(x1), _diff(diff) {}
+
+  stream_step next (T &out)
+  {
+    out = _next;
+    _next += _diff;
+    return stream_step::yield;
+  }
+
+  T _next, _diff;
+};
+
+// x1, x1 + diff, ... up to xn (x1 is always part of the stream)
+//
+//  No step is taken past xn, so the stream ends at the last element in
+//  range even where one more step would wrap around (e.g. 250 to 255 as
+//  unsigned char).
+template <class T, bool Integral = std::is_integral<T>::value>
+struct enum_from_to_stream : stream_base<enum_from_to_stream<T>, T> {
+  enum_from_to_stream (T x1, T diff, T xn) : _next(x1), _diff(diff), _last(xn) {}
+
+  stream_step next (T &out)
+  {
+    if (_done) return stream_step::done;
+    out = _next;
+    if (_next <= _last && _next + _diff <= _last) _next += _diff;
+    else _done = true;
+    return stream_step::yield;
+  }
+
+  T    _next, _diff, _last;
+  bool _done = false;
+};
+
+// (integral elements: the position one step past the last element is
+//  worked out up front, in unsigned arithmetic wide enough that no list of
+//  a narrower type wraps around to it, so the loop tests for it as a plain
+//  counting loop would)
+template <class T>
+struct enum_from_to_stream<T, true> : stream_base<enum_from_to_stream<T>, T> {
+  using U = std::uintmax_t;
+
+  enum_from_to_stream (T x1, T diff, T xn) : _next(U(x1)), _diff(x1 <= xn ? U(diff) : U(1)), _end(_past_last(x1, diff, xn)) {}
+
+  stream_step next (T &out)
+  {
+    if (_next == _end) return stream_step::done;
+    out = T(_next);
+    _next += _diff;
+    return stream_step::yield;
+  }
+
+  static U _past_last (T x1, T diff, T xn)
+  {
+    // (only x1 when it is above xn; a step that does not move never
+    //  passes xn, and one that moves down ends at the type's minimum)
+    if (!(x1 <= xn) || diff == 0) return U(x1) + 1;
+    U steps = diff > 0 ? (U(xn) - U(x1))/U(diff) : (U(x1) - U(std::numeric_limits<T>::min()))/(U(0) - U(diff));
+    U end = U(x1) + (steps + 1)*U(diff);
+    // (only a list over the whole range of a 64-bit type comes back round
+    //  to x1; it stops one element short instead of before the first)
+    return end == U(x1) ? end - U(diff) : end;
+  }
+
+  U _next, _diff, _end;
+};
+
+// a stream is itself, a List is walked in place
+template <class S, class T>
+const S& stream_of (const stream_base<S, T> &s) {return s.derived();}
+template <class T, class A, class R>
+list_stream<T, A, R> stream_of (const List<T, A, R> &l) {return list_stream<T, A, R>(l);}
+
+
+
+// //////////////////
+// stream combinators
+// //////////////////
+
+// f applied to every element
+template <class S, class F>
+struct map_stream :
+  stream_base<map_stream<S, F>, typename std::decay<decltype(std::declval<const F&>()(std::declval<const typename S::value_type&>()))>::type> {
+  using value_type = typename std::decay<decltype(std::declval<const F&>()(std::declval<const typename S::value_type&>()))>::type;
+
+  map_stream (S in, F f) : _in(std::move(in)), _f(std::move(f)) {}
+
+  stream_step next (value_type &out)
+  {
+    typename S::value_type x{};
+    auto step = _in.next(x);
+    if (step == stream_step::yield) out = _f(x);
+    return step;
+  }
+
+  S _in;
+  F _f;
+};
+
+// the elements that satisfy p (the others are skipped)
+template <class S, class P>
+struct filter_stream : stream_base<filter_stream<S, P>, typename S::value_type> {
+  using value_type = typename S::value_type;
+
+  filter_stream (S in, P p) : _in(std::move(in)), _p(std::move(p)) {}
+
+  stream_step next (value_type &out)
+  {
+    auto step = _in.next(out);
+    if (step == stream_step::yield && !_p(out)) return stream_step::skip;
+    return step;
+  }
+
+  S _in;
+  P _p;
+};
+
+// the first n elements
+template <class S>
+struct take_stream : stream_base<take_stream<S>, typename S::value_type> {
+  using value_type = typename S::value_type;
+
+  take_stream (std::size_t n, S in) : _in(std::move(in)), _n(n) {}
+
+  stream_step next (value_type &out)
+  {
+    if (_n == 0) return stream_step::done;
+    auto step = _in.next(out);
+    if (step == stream_step::yield) --_n;
+    return step;
+  }
+
+  S           _in;
+  std::size_t _n;
+};
+
+// all but the first n elements (the dropped ones are skipped)
+template <class S>
+struct drop_stream : stream_base<drop_stream<S>, typename S::value_type> {
+  using value_type = typename S::value_type;
+
+  drop_stream (std::size_t n, S in) : _in(std::move(in)), _n(n) {}
+
+  stream_step next (value_type &out)
+  {
+    auto step = _in.next(out);
+    if (_n == 0 || step != stream_step::yield) return step;
+    --_n;
+    return stream_step::skip;
+  }
+
+  S           _in;
+  std::size_t _n;
+};
+
+// f applied to corresponding elements (until either stream is done);
+//  an element of the first stream is held while the second one skips
+template <class S1, class S2, class F>
+struct zip_with_stream :
+  stream_base<zip_with_stream<S1, S2, F>, typename std::decay<decltype(std::declval<const F&>()(
+      std::declval<const typename S1::value_type&>(), std::declval<const typename S2::value_type&>()))>::type> {
+  using value_type = typename std::decay<decltype(std::declval<const F&>()(
+      std::declval<const typename S1::value_type&>(), std::declval<const typename S2::value_type&>()))>::type;
+
+  zip_with_stream (S1 in1, S2 in2, F f) : _in1(std::move(in1)), _in2(std::move(in2)), _f(std::move(f)) {}
+
+  stream_step next (value_type &out)
+  {
+    if (!_has_x) {
+      auto step = _in1.next(_x);
+      if (step != stream_step::yield) return step;
+      _has_x = true;
+    }
+    typename S2::value_type y{};
+    auto step = _in2.next(y);
+    if (step != stream_step::yield) return step;
+    _has_x = false;
+    out = _f(_x, y);
+    return stream_step::yield;
+  }
+
+  S1                       _in1;
+  S2                       _in2;
+  F                        _f;
+  typename S1::value_type  _x{};
+  bool                     _has_x = false;
+};
+
+// strict left fold (the accumulator has the type of z)
+template <class F, class Z, class S>
+Z fold_stream (const F &f, Z acc, S s)
+{
+  typename S::value_type x{};
+  for (auto step = s.next(x); step != stream_step::done; step = s.next(x))
+    if (step == stream_step::yield) acc = f(acc, x);
+  return acc;
+}
+
+
+
+// ////////////////////////////////////////////////////////////////////////
+// fusion through composition
+//
+//  A generator functoid whose func is a stream_producer makes a List as
+//  usual, but a fully applied one composed under a stream_consumer (e.g.
+//  foldl(f, z) * map(g) * enumFromTo(1, 2, n)) hands the consumer its
+//  stream instead, so the whole pipeline runs without a List in between.
+// ////////////////////////////////////////////////////////////////////////
+namespace _impl
+{
+
+// func of a generator (stream makes the stream from the generator's arguments)
+template <class F>
+struct stream_producer {
+  F stream;
+
+  template <class ...Args>
+  auto operator() (Args&& ...args) const {return stream(std::forward<Args>(args)...).to_list();}
+};
+
+template <class F>
+constexpr stream_producer<typename std::decay<F>::type> make_stream_producer (F &&f)
+{
+  stream_producer<typename std::decay<F>::type> temp{std::forward<F>(f)};
+  return temp;
+}
+
+// func of a combinator whose last argument may be a stream
+template <class F>
+struct stream_consumer : F {};
+
+template <class F>
+constexpr stream_consumer<typename std::decay<F>::type> make_stream_consumer (F &&f)
+{
+  stream_consumer<typename std::decay<F>::type> temp{std::forward<F>(f)};
+  return temp;
+}
+
+// whether a unary functoid's func (after partial application) is a
+//  stream_consumer, or a pipeline whose innermost stage is
+template <class F> struct is_stream_consumer : std::false_type {};
+template <class F, class ...Bound>
+struct is_stream_consumer<bound_front<stream_consumer<F>, Bound...>> : std::true_type {};
+template <class ...Fs>
+struct is_stream_consumer<pipeline<Fs...>> :
+  is_stream_consumer<typename std::tuple_element<sizeof...(Fs) - 1, std::tuple<Fs...>>::type> {};
+
+}
+
+template <class F1, class G, class ...Bound,
+          typename std::enable_if<_impl::is_stream_consumer<F1>::value, int>::type = 0>
+constexpr auto operator* (const curried_type<F1, 1> &c1, const curried_type<_impl::bound_front<_impl::stream_producer<G>, Bound...>, 0> &c2)
+{
+  return make_curriable<0>(_impl::compose(c1.func, _impl::bound_front<G, Bound...>{c2.func.f.stream, c2.func.bound}));
+}
+template <class F1, class G, class ...Bound,
+          typename std::enable_if<_impl::is_stream_consumer<F1>::value, int>::type = 0>
+constexpr auto operator* (curried_type<F1, 1>&& c1, const curried_type<_impl::bound_front<_impl::stream_producer<G>, Bound...>, 0> &c2)
+{
+  return make_curriable<0>(_impl::compose(std::move(c1.func), _impl::bound_front<G, Bound...>{c2.func.f.stream, c2.func.bound}));
+}
+template <class F1, class G, class ...Bound,
+          typename std::enable_if<_impl::is_stream_consumer<F1>::value, int>::type = 0>
+constexpr auto operator* (const curried_type<F1, 1> &c1, curried_type<_impl::bound_front<_impl::stream_producer<G>, Bound...>, 0>&& c2)
+{
+  return make_curriable<0>(_impl::compose(c1.func, _impl::bound_front<G, Bound...>{std::move(c2.func.f.stream), std::move(c2.func.bound)}));
+}
+template <class F1, class G, class ...Bound,
+          typename std::enable_if<_impl::is_stream_consumer<F1>::value, int>::type = 0>
+constexpr auto operator* (curried_type<F1, 1>&& c1, curried_type<_impl::bound_front<_impl::stream_producer<G>, Bound...>, 0>&& c2)
+{
+  return make_curriable<0>(_impl::compose(std::move(c1.func), _impl::bound_front<G, Bound...>{std::move(c2.func.f.stream), std::move(c2.func.bound)}));
+}
+
+
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef FCPP_THREAD_POOL_H
+#define FCPP_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fcpp
+{
+
+// bounded, work-stealing thread pool
+//
+//  Every worker owns a deque: it pops its own work from the back (LIFO) and
+//  steals from the front (FIFO) of the other workers' deques when it runs
+//  dry. Work submitted from a worker lands in that worker's deque, anything
+//  else is spread round-robin. At most "capacity" tasks can be queued;
+//  try_submit reports when the pool is full so callers can fall back to
+//  evaluating on their own thread.
+struct thread_pool {
+  using task_type = std::function<void()>;
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  explicit thread_pool (std::size_t threads = default_size(), std::size_t capacity = 4096) :
+    _capacity(capacity), _queues(threads > 0 ? threads : 1)
+  {
+    for (std::size_t i = 0; i < _queues.size(); ++i)
+      _workers.emplace_back([this, i]() {this->_run(i);});
+  }
+
+  // finishes all queued tasks before joining
+  ~thread_pool ()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for (auto &worker : _workers)
+      worker.join();
+  }
+
+  static std::size_t default_size ()
+  {
+    auto n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+  }
+
+  std::size_t size () const {return _workers.size();}
+  std::size_t capacity () const {return _capacity;}
+  std::size_t pending () const {return _pending.load(std::memory_order_relaxed);}
+
+  // returns false (and drops the task) if the pool is full
+  bool try_submit (task_type task)
+  {
+    if (_pending.fetch_add(1, std::memory_order_acq_rel) >= _capacity) {
+      _pending.fetch_sub(1, std::memory_order_acq_rel);
+      return false;
+    }
+    auto &self = _this_worker();
+    std::size_t index = self.pool == this ? self.index :
+      _next.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+    {
+      std::lock_guard<std::mutex> lock(_queues[index].mutex);
+      _queues[index].tasks.push_back(std::move(task));
+    }
+    {
+      // pairs with the predicate check in _run so a wake up is never lost
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+    }
+    _wake.notify_one();
+    return true;
+  }
+
+  // runs the task on the calling thread if the pool is full
+  void submit (task_type task)
+  {
+    if (!try_submit(task)) task();
+  }
+
+  // "private:" stuff
+  struct worker_queue {
+    std::mutex mutex;
+    std::deque<task_type> tasks;
+  };
+  struct worker_id {
+    const thread_pool *pool;
+    std::size_t index;
+  };
+
+  static worker_id& _this_worker ()
+  {
+    static thread_local worker_id id{nullptr, 0};
+    return id;
+  }
+
+  bool _pop (std::size_t index, task_type &task)
+  {
+    // own work first (most recently pushed) ...
+    {
+      auto &queue = _queues[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+      }
+    }
+    // ... then steal the oldest work of the others
+    for (std::size_t i = 1; i < _queues.size(); ++i) {
+      auto &queue = _queues[(index + i) % _queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void _run (std::size_t index)
+  {
+    _this_worker() = worker_id{this, index};
+    task_type task;
+    while (true) {
+      if (_pop(index, task)) {
+        _pending.fetch_sub(1, std::memory_order_acq_rel);
+        task();
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(_sleep_mutex);
+      if (_pending.load(std::memory_order_acquire) > 0) continue;
+      if (_stop) return;
+      _wake.wait(lock, [this]() {return _stop || _pending.load(std::memory_order_acquire) > 0;});
+    }
+  }
+
+  const std::size_t         _capacity;
+  std::vector<worker_queue> _queues;
+  std::vector<std::thread>  _workers;
+  std::atomic<std::size_t>  _pending{0};
+  std::atomic<std::size_t>  _next{0};
+  std::mutex                _sleep_mutex;
+  std::condition_variable   _wake;
+  bool                      _stop = false;
+};
+
+
+
+// pool used when none is given explicitly
+inline thread_pool& default_thread_pool ()
+{
+  static thread_pool pool;
+  return pool;
+}
+
+}
+
+#endif
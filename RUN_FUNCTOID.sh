@@ -1,7 +1,7 @@
 mkdir bin
 rm -rf bin/functoid
 
-#g++ -std=c++14 -I. -O$1 -Wall src/functoid.cpp -o bin/functoid
-clang++ -std=c++14 -I. -DFCPP_TREADSAFE_SUSP -O$1 -Wall src/functoid.cpp -o bin/functoid
+#g++ -std=c++17 -I. -O$1 -Wall src/functoid.cpp -o bin/functoid
+clang++ -std=c++17 -I. -DFCPP_TREADSAFE_SUSP -O$1 -Wall -pthread src/functoid.cpp -o bin/functoid
 
-./bin/functoid
+./bin/functoid "${@:2}"
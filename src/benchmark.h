@@ -0,0 +1,313 @@
+#ifndef FCPP_SRC_BENCHMARK_H
+#define FCPP_SRC_BENCHMARK_H
+
+// minimal benchmark harness for the timing programs in src/
+//
+//  Every benchmark body runs one batch of "items" operations. A batch is
+//  repeated (after a warm up run) and the per-item times of the repetitions
+//  are summarized by their median and percentiles. Results are printed as a
+//  table or, for comparing runs across commits, as JSON or CSV.
+//
+//  command line: [--format=text|json|csv] [--repetitions=N] [--filter=substring]
+//  Linux hardware counters are collected when built with -DFCPP_BENCH_PERF.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(FCPP_BENCH_PERF) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench
+{
+
+// /////////////////
+// compiler barriers
+// /////////////////
+template <class T>
+inline void do_not_optimize (const T &value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <class T>
+inline void do_not_optimize (T &value)
+{
+  asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+inline void clobber_memory ()
+{
+  asm volatile("" : : : "memory");
+}
+
+
+
+// ////////////////////////////////////////
+// optional hardware counters (perf_event)
+// ////////////////////////////////////////
+struct perf_counters {
+  static constexpr int count = 4;
+  static const char* name (int i)
+  {
+    static const char *names[count] = {"cycles", "instructions", "branch_misses", "cache_misses"};
+    return names[i];
+  }
+
+#if defined(FCPP_BENCH_PERF) && defined(__linux__)
+  perf_counters ()
+  {
+    const std::uint64_t configs[count] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                          PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < count; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+  }
+  ~perf_counters ()
+  {
+    for (int fd : fds)
+      if (fd >= 0) close(fd);
+  }
+  bool available () const {return fds[0] >= 0;}
+  void start ()
+  {
+    for (int fd : fds)
+      if (fd >= 0) {ioctl(fd, PERF_EVENT_IOC_RESET, 0); ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);}
+  }
+  void stop (double *values)
+  {
+    for (int i = 0; i < count; ++i) {
+      values[i] = -1.0;
+      if (fds[i] < 0) continue;
+      ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+      std::uint64_t v = 0;
+      if (read(fds[i], &v, sizeof(v)) == sizeof(v)) values[i] = static_cast<double>(v);
+    }
+  }
+
+  int fds[count];
+#else
+  bool available () const {return false;}
+  void start () {}
+  void stop (double *values) {for (int i = 0; i < count; ++i) values[i] = -1.0;}
+#endif
+};
+
+
+
+// ///////
+// results
+// ///////
+struct result {
+  std::string name;
+  std::size_t items;
+  std::size_t repetitions;
+  double median_ns, p10_ns, p90_ns, min_ns, max_ns, mean_ns;
+  double counters[perf_counters::count];  // per item (median), negative if unavailable
+};
+
+inline double percentile (std::vector<double> sorted, double p)
+{
+  std::sort(sorted.begin(), sorted.end());
+  if (sorted.empty()) return 0.0;
+  double pos = p*(sorted.size() - 1);
+  auto lo = static_cast<std::size_t>(pos);
+  auto hi = std::min(lo + 1, sorted.size() - 1);
+  return sorted[lo] + (pos - lo)*(sorted[hi] - sorted[lo]);
+}
+
+
+
+// ///////////////////////////////////////////
+// a named collection of benchmarks and checks
+// ///////////////////////////////////////////
+struct suite {
+  enum class format_type {text, json, csv};
+
+  suite (std::string title, int argc, char **argv) : _title(std::move(title))
+  {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      if (arg == "--format=json") _format = format_type::json;
+      else if (arg == "--format=csv") _format = format_type::csv;
+      else if (arg == "--format=text") _format = format_type::text;
+      else if (arg.compare(0, 14, "--repetitions=") == 0) _repetitions = std::max(1, std::stoi(arg.substr(14)));
+      else if (arg.compare(0, 9, "--filter=") == 0) _filter = arg.substr(9);
+      else std::cerr << "ignoring unknown argument " << arg << std::endl;
+    }
+    if (_format == format_type::text)
+      std::cout << std::endl << _title << " (median of " << _repetitions << " repetitions, ns per item)" << std::endl;
+  }
+
+  ~suite ()
+  {
+    if (_format == format_type::json) _print_json();
+    else if (_format == format_type::csv) _print_csv();
+    else if (_failed_checks) std::cout << std::endl << _failed_checks << " value check(s) FAILED" << std::endl;
+  }
+
+  int exit_code () const {return _failed_checks ? 1 : 0;}
+
+  // headings only show up in text output
+  void section (const std::string &heading)
+  {
+    if (_format == format_type::text) std::cout << std::endl << heading << std::endl;
+  }
+
+  // compares an expected value against the value produced by fcpp
+  template <class T, class U>
+  bool check (const std::string &what, const T &expected, const U &actual)
+  {
+    bool ok = (expected == actual);
+    if (!ok) ++_failed_checks;
+    if (_format == format_type::text || !ok) {
+      auto &os = (_format == format_type::text) ? std::cout : std::cerr;
+      os << std::boolalpha << "Value check (" << what << "): " << expected << " == " << actual << (ok ? "" : "  <-- FAILED") << std::endl;
+    }
+    return ok;
+  }
+
+  // body performs "items" operations per call
+  template <class Body>
+  void run (const std::string &name, std::size_t items, Body &&body)
+  {
+    run(name, items, []() {}, std::forward<Body>(body));
+  }
+
+  // setup runs untimed before every repetition (e.g. to create fresh thunks)
+  template <class Setup, class Body>
+  void run (const std::string &name, std::size_t items, Setup &&setup, Body &&body)
+  {
+    if (!_filter.empty() && name.find(_filter) == std::string::npos) return;
+    using clock = std::chrono::steady_clock;
+    std::vector<double> times;
+    std::vector<double> counter_values[perf_counters::count];
+    double values[perf_counters::count];
+    // warm up
+    setup();
+    body();
+    clobber_memory();
+    for (int r = 0; r < _repetitions; ++r) {
+      setup();
+      clobber_memory();
+      _perf.start();
+      auto start = clock::now();
+      body();
+      clobber_memory();
+      auto end = clock::now();
+      _perf.stop(values);
+      times.push_back(std::chrono::duration<double, std::nano>(end - start).count()/static_cast<double>(items));
+      for (int i = 0; i < perf_counters::count; ++i)
+        counter_values[i].push_back(values[i]/static_cast<double>(items));
+    }
+    result res;
+    res.name = name;
+    res.items = items;
+    res.repetitions = times.size();
+    res.median_ns = percentile(times, 0.5);
+    res.p10_ns = percentile(times, 0.1);
+    res.p90_ns = percentile(times, 0.9);
+    res.min_ns = *std::min_element(times.begin(), times.end());
+    res.max_ns = *std::max_element(times.begin(), times.end());
+    res.mean_ns = 0.0;
+    for (auto t : times) res.mean_ns += t/static_cast<double>(times.size());
+    for (int i = 0; i < perf_counters::count; ++i)
+      res.counters[i] = _perf.available() ? percentile(counter_values[i], 0.5) : -1.0;
+    _results.push_back(res);
+    if (_format == format_type::text) _print_text(res);
+  }
+
+  // "private:" stuff
+  void _print_text (const result &res) const
+  {
+    char line[256];
+    std::snprintf(line, sizeof(line), "  %-60s %10.3f ns  (p10 %.3f, p90 %.3f, %zu items)",
+        res.name.c_str(), res.median_ns, res.p10_ns, res.p90_ns, res.items);
+    std::cout << line;
+    for (int i = 0; i < perf_counters::count; ++i)
+      if (res.counters[i] >= 0.0) std::cout << "  " << perf_counters::name(i) << " " << res.counters[i];
+    std::cout << std::endl;
+  }
+
+  static std::string _escape (const std::string &s)
+  {
+    std::string out;
+    for (char c : s) {
+      if (c == '"' || c == '\\') out += '\\';
+      out += c;
+    }
+    return out;
+  }
+
+  void _print_json () const
+  {
+    std::ostringstream os;
+    os << "{\n  \"suite\": \"" << _escape(_title) << "\",\n";
+#if defined(FCPP_TREADSAFE_SUSP)
+    os << "  \"threadsafe_suspensions\": true,\n";
+#else
+    os << "  \"threadsafe_suspensions\": false,\n";
+#endif
+    os << "  \"failed_checks\": " << _failed_checks << ",\n  \"benchmarks\": [";
+    for (std::size_t b = 0; b < _results.size(); ++b) {
+      const auto &res = _results[b];
+      os << (b ? ",\n" : "\n") << "    {\"name\": \"" << _escape(res.name) << "\", \"items\": " << res.items
+         << ", \"repetitions\": " << res.repetitions << ", \"median_ns\": " << res.median_ns
+         << ", \"p10_ns\": " << res.p10_ns << ", \"p90_ns\": " << res.p90_ns << ", \"min_ns\": " << res.min_ns
+         << ", \"max_ns\": " << res.max_ns << ", \"mean_ns\": " << res.mean_ns;
+      for (int i = 0; i < perf_counters::count; ++i)
+        if (res.counters[i] >= 0.0) os << ", \"" << perf_counters::name(i) << "\": " << res.counters[i];
+      os << "}";
+    }
+    os << "\n  ]\n}\n";
+    std::cout << os.str();
+  }
+
+  void _print_csv () const
+  {
+    std::cout << "suite,name,items,repetitions,median_ns,p10_ns,p90_ns,min_ns,max_ns,mean_ns";
+    for (int i = 0; i < perf_counters::count; ++i) std::cout << "," << perf_counters::name(i);
+    std::cout << "\n";
+    for (const auto &res : _results) {
+      std::cout << '"' << _title << "\",\"" << res.name << "\"," << res.items << "," << res.repetitions << ","
+                << res.median_ns << "," << res.p10_ns << "," << res.p90_ns << "," << res.min_ns << ","
+                << res.max_ns << "," << res.mean_ns;
+      for (int i = 0; i < perf_counters::count; ++i) {
+        std::cout << ",";
+        if (res.counters[i] >= 0.0) std::cout << res.counters[i];
+      }
+      std::cout << "\n";
+    }
+  }
+
+  std::string         _title;
+  format_type         _format = format_type::text;
+  int                 _repetitions = 15;
+  std::string         _filter;
+  int                 _failed_checks = 0;
+  perf_counters       _perf;
+  std::vector<result> _results;
+};
+
+}
+
+#endif
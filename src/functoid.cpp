@@ -1,10 +1,19 @@
 #include <iostream>
 #include <random>
-#include <chrono>
 #include <functional>
-#include <list>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <memory>
+#include <array>
+#include <stdexcept>
 
 #include "FC++14/functoid.h"
+#include "FC++14/async.h"
+#include "FC++14/memoize.h"
+#include "FC++14/function_ref.h"
+#include "FC++14/batch.h"
+#include "src/benchmark.h"
 
 struct FuncObject {
   auto operator() (double a, double b) const
@@ -18,386 +27,358 @@ auto addtogether (double a, double b)
 {return a + b;}
 
 
+#if __cpp_constexpr >= 201603L
+// literal functoids (lambdas are literal types as of C++17) fold at compile time
+constexpr auto ct_scale = fcpp::make_curriable<2>([](int a, int x) {return a*x;});
+constexpr auto ct_offset = fcpp::make_curriable<2>([](int b, int x) {return x + b;});
+constexpr auto ct_affine = ct_offset(3) * ct_scale(2);
+static_assert(ct_scale(2)(4)() == 8, "constexpr partial application");
+static_assert(ct_affine(4)() == 11, "constexpr composition");
+static_assert((4 %ct_offset% 3)() == 7, "constexpr infix application");
+static_assert(fcpp::make_eager(ct_affine)(4) == 11, "constexpr eager application");
+
+template <std::size_t ...I>
+constexpr std::array<int, sizeof...(I)> make_affine_table (std::index_sequence<I...>)
+{return {{fcpp::make_eager(ct_affine)(static_cast<int>(I))...}};}
+constexpr auto affine_table = make_affine_table(std::make_index_sequence<256>{});
+#endif
+
+
 
 
-using namespace std::chrono;
 using namespace fcpp;
+using bench::do_not_optimize;
 
-int main ()
+int main (int argc, char **argv)
 {
-  std::cout << std::endl << "Timing comparisons for curried and composable functions" << std::endl;
-  std::cout << "CAUTION: assignments seem to interact with timing - take all number with a grain of salt\n" << std::endl;
+  bench::suite suite("Timing comparisons for curried and composable functions", argc, argv);
 
   // random number generation setup
   std::random_device rd;
   std::mt19937 gen(rd());
   std::uniform_int_distribution<> dis(-10, 10);
   auto random_num = [&gen, &dis]() {return dis(gen);};
-  // setup clock for timing
-  auto clock = steady_clock::now;
-  auto start = clock();
-  auto end = clock();
-  auto ave_diff = duration <double, std::nano> (end - start).count();
-  // max testing loop
-  auto max_loop = 1000;
-  // loop sum (so compiler doesn't optimize the loops away)
-  long long loop_sum = 0;
-  // generate random numbers
-  std::list<int> random_nums1,
-    random_nums2,
-    random_nums3,
-    random_nums4;
-  for (auto i = 0; i < max_loop; ++i) {
-    random_nums1.push_back(random_num());
-    random_nums2.push_back(random_num());
-    random_nums3.push_back(random_num());
-    random_nums4.push_back(random_num());
+  // generate random numbers (1000 for one and two argument loops, 100 for three argument loops)
+  std::vector<int> nums1, nums2, short1, short2, short3;
+  for (auto i = 0; i < 1000; ++i) {
+    nums1.push_back(random_num());
+    nums2.push_back(random_num());
+  }
+  for (auto i = 0; i < 100; ++i) {
+    short1.push_back(random_num());
+    short2.push_back(random_num());
+    short3.push_back(random_num());
   }
+  const auto n1 = nums1.size(), n2 = nums1.size()*nums2.size(), n3 = short1.size()*short2.size()*short3.size();
+  // every result goes through do_not_optimize so the loops cannot be folded away
+  auto over1 = [&](auto &&f) {return [&, f]() {for (auto a : nums1) do_not_optimize(f(a));};};
+  auto over2 = [&](auto &&f) {return [&, f]() {for (auto a : nums1) for (auto b : nums2) do_not_optimize(f(a, b));};};
+  auto over3 = [&](auto &&f)
+    {return [&, f]() {for (auto a : short1) for (auto b : short2) for (auto c : short3) do_not_optimize(f(a, b, c));};};
 
 
 
   // wrapping normal function
-  std::cout << "Normal function" << std::endl;
+  suite.section("Normal function");
   auto addtoo = make_curriable(addtogether);
-  std::cout << "Value check: " << addtogether(2,3) << " == " << addtoo(2,3)() << std::endl;
-
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += num1 + num2;
-
-  // no function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += num1 + num2;
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " addition of two numbers: " << ave_diff << " ns" << std::endl;
-
-  // normal function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += addtogether(num1, num2);
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (normal function) addtogether: " << ave_diff << " ns" << std::endl;
-
-  // curriable-wrapped function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += addtoo(num1, num2)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (curried function) addtoo: " << ave_diff << " ns" << std::endl;
+  suite.check("addtoo", addtogether(2,3), addtoo(2,3)());
 
+  suite.run("function/inline_addition", n2, over2([](int a, int b) {return a + b;}));
+  suite.run("function/plain_call", n2, over2([](int a, int b) {return addtogether(a, b);}));
+  suite.run("function/curried_call", n2, over2([&](int a, int b) {return addtoo(a, b)();}));
 
 
 
   // wrapping function object
-  std::cout << std::endl << "Function object" << std::endl;
+  suite.section("Function object");
   auto addobject = make_curriable(func_object, &FuncObject::operator());
-  std::cout << "Value check: " << func_object(2,3) << " == " << addobject(2)(3)() << std::endl;
-
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += num1 + num2;
-
-  // no function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += num1 + num2;
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " addition of two numbers: " << ave_diff << " ns" << std::endl;
-
-  // normal function object call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += func_object(num1, num2);
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (normal function object) func_object: " << ave_diff << " ns" << std::endl;
-
-  // curriable-wrapped function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += addobject(num1, num2)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (curried function) addobject: " << ave_diff << " ns" << std::endl;
+  suite.check("addobject", func_object(2,3), addobject(2)(3)());
 
+  suite.run("function_object/plain_call", n2, over2([](int a, int b) {return func_object(a, b);}));
+  suite.run("function_object/curried_call", n2, over2([&](int a, int b) {return addobject(a, b)();}));
 
 
 
   // wrapping generic lambda
-  std::cout << std::endl << "Generic lambda (2 arguments)" << std::endl;
+  suite.section("Generic lambda (2 arguments)");
   auto adder = make_curriable<2>([](auto x1, auto x2) {return x1 + x2 + x2;});
   auto _adder = [](auto x1, auto x2) {return x1 + x2 + x2;};
-  std::cout << "Value check: " << _adder(2,3) << " == " << adder(2)(3)() << std::endl;
-
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += num1 + num2 + num2;
-
-  // no function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += num1 + num2 + num2;
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " addition of two numbers: " << ave_diff << " ns" << std::endl;
-
-  // lambda call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += _adder(num1, num2);
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (generic lambda) _adder: " << ave_diff << " ns" << std::endl;
-
-  // curriable-wrapped function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += adder(num1, num2)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (2 arg curried function) adder: " << ave_diff << " ns" << std::endl;
-
-  // curriable-wrapped function call
-  std::cout << std::endl << "Generic lambda (2 arguments reduced to 1 argument)" << std::endl;
-  auto addtwo = adder(2);
-  std::cout << "Value check: " << _adder(2, 3) << " == " << addtwo(3)() << std::endl;
-  std::cout << "Are the stored function type and temporary type the same? : " << std::boolalpha << std::is_same<decltype(addtwo), decltype(adder(2))>::value << std::endl;
+  suite.check("adder", _adder(2,3), adder(2)(3)());
+
+  suite.run("currying/2args/inline_addition", n2, over2([](int a, int b) {return a + b + b;}));
+  suite.run("currying/2args/lambda", n2, over2(_adder));
+  suite.run("currying/2args/all_at_once", n2, over2([&](int a, int b) {return adder(a, b)();}));
+  suite.run("currying/2args/one_at_a_time", n2, over2([&](int a, int b) {return adder(a)(b)();}));
 
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    loop_sum += addtwo(num1)();
+  // partially applied
+  suite.section("Generic lambda (2 arguments reduced to 1 argument)");
+  auto addtwo = adder(2);
+  suite.check("addtwo", _adder(2, 3), addtwo(3)());
+  suite.check("stored and temporary partial application types agree", true,
+      std::is_same<decltype(addtwo), decltype(adder(2))>::value);
 
-  start = clock();
-  for (auto num1 : random_nums1)
-    loop_sum += addtwo(num1)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " calls to (1 arg curried function) addtwo: " << ave_diff << " ns" << std::endl;
+  suite.run("currying/partially_applied", n1, over1([&](int a) {return addtwo(a)();}));
 
 
 
-  // 3 argument generic lambda with placeholders
-  std::cout << std::endl << "Generic lambda (3 arguments)" << std::endl;
+  // 3 argument generic lambda
+  suite.section("Generic lambda (3 arguments)");
   auto addtrio = make_curriable<3>([](auto x1, auto x2, auto x3) {return x1 + x2 + x2 + x3 + x3 + x3;});
   auto _addtrio = [](auto x1, auto x2, auto x3) {return x1 + x2 + x2 + x3 + x3 + x3;};
-  std::cout << "Value check: " << _addtrio(2,3,4) << " == " << addtrio(2,3,4)() << " == " << addtrio(2,3)(4)() << " == " << addtrio(2)(3)(4)() << std::endl;
-
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      for (auto num3 : random_nums3)
-        loop_sum += num1 + num2 + num2 + num3 + num3 + num3;
-
-  // no function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      for (auto num3 : random_nums3)
-        loop_sum += num1 + num2 + num2 + num3 + num3 + num3;
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size()*random_nums3.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size()*random_nums3.size() << " addition of three numbers: " << ave_diff << " ns" << std::endl;
-
-  // lambda call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      for (auto num3 : random_nums3)
-        loop_sum += _addtrio(num1, num2, num3);
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size()*random_nums3.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size()*random_nums3.size() << " calls to (lambda function) _addtrio: " << ave_diff << " ns" << std::endl;
-
-  // curriable-wrapped function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      for (auto num3 : random_nums3)
-        loop_sum += addtrio(num1, num2, num3)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size()*random_nums3.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size()*random_nums3.size() << " calls to (3 arg curried function) addtrio: " << ave_diff << " ns" << std::endl;
-
-
-  std::cout << std::endl << "Generic lambda (3 arguments, 2 placeholders)" << std::endl;
-  auto add2p = addtrio(_,_,4);
-  auto _add2p = [](auto&& x1, auto&& x2) {return x1 + x2 + x2 + 4 + 4 + 4;};
-  std::cout << "Value check: " << _add2p(2,3) << " == " << add2p(2,3)() << " == " << add2p(2)(3)() << std::endl;
+  suite.check("addtrio(2,3,4)", _addtrio(2,3,4), addtrio(2,3,4)());
+  suite.check("addtrio(2,3)(4)", _addtrio(2,3,4), addtrio(2,3)(4)());
+  suite.check("addtrio(2)(3)(4)", _addtrio(2,3,4), addtrio(2)(3)(4)());
+  suite.check("sizeof(addtrio(2)) <= sizeof(addtrio(2)(3))", true, sizeof(addtrio(2)) <= sizeof(addtrio(2)(3)));
+
+  suite.run("currying/3args/inline_addition", n3, over3([](int a, int b, int c) {return a + b + b + c + c + c;}));
+  suite.run("currying/3args/lambda", n3, over3(_addtrio));
+  suite.run("currying/3args/all_at_once", n3, over3([&](int a, int b, int c) {return addtrio(a, b, c)();}));
+  suite.run("currying/3args/one_at_a_time", n3, over3([&](int a, int b, int c) {return addtrio(a)(b)(c)();}));
+
+
+  // temporaries move their bound arguments along instead of copying them
+  suite.section("Generic lambda (heavyweight and move-only arguments)");
+  auto _heavy = [](std::vector<int> v, int x, int y) {return static_cast<int>(v.size()) + x + y;};
+  auto heavy = make_curriable<3>(_heavy);
+  auto make_vector = [](int a) {return std::vector<int>(1000 + a, a);};
+  auto unique_add = make_curriable<2>([](std::unique_ptr<int> p, int x) {return *p + x;});
+  suite.check("heavy", _heavy(make_vector(0), 2, 3), heavy(make_vector(0))(2)(3)());
+  suite.check("unique_add", 7, unique_add(std::make_unique<int>(4))(3)());
 
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += num1 + num2;
+  suite.run("currying/heavyweight/lambda", n1, over1([&](int a) {return _heavy(make_vector(a), a, 1);}));
+  suite.run("currying/heavyweight/temporary_chain", n1, over1([&](int a) {return heavy(make_vector(a))(a)(1)();}));
 
-  // lambda call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += _add2p(num1, num2);
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (lambda function) _add2p: " << ave_diff << " ns" << std::endl;
 
-  // curriable-wrapped function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += add2p(num1, num2)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (3 arg curried function, 2 placeholders) add2p: " << ave_diff << " ns" << std::endl;
+
+  // placeholders
+  suite.section("Generic lambda (3 arguments, 2 placeholders)");
+  auto add2p = addtrio(_,_,4);
+  auto _add2p = [](auto&& x1, auto&& x2) {return x1 + x2 + x2 + 4 + 4 + 4;};
+  suite.check("add2p(2,3)", _add2p(2,3), add2p(2,3)());
+  suite.check("add2p(2)(3)", _add2p(2,3), add2p(2)(3)());
+
+  suite.run("placeholders/lambda", n2, over2(_add2p));
+  suite.run("placeholders/all_at_once", n2, over2([&](int a, int b) {return add2p(a, b)();}));
+  suite.run("placeholders/one_at_a_time", n2, over2([&](int a, int b) {return add2p(a)(b)();}));
 
 
 
   // composition
-  std::cout << std::endl << "Composition (with * operator)" << std::endl;
+  suite.section("Composition (with * operator)");
   auto comp = addtwo * addtwo * addtwo * addtrio(2);
   auto manual_comp = [](auto a, auto b) {return 2 + 2*(2 + 2*(2 + 2*(2 + 2*a + 3*b)));};
-  std::cout << "Value check: " << manual_comp(5, 3) << " == " << comp(5, 3)() << std::endl;
-
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += comp(num1, num2)();
-
-  // lambda call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += manual_comp(num1, num2);
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (generic lambda) manual_comp: " << ave_diff << " ns" << std::endl;
-
-  // composed, curriable-wrapped function call
-  start = clock();
-  for (auto num1 : random_nums1)
-    for (auto num2 : random_nums2)
-      loop_sum += comp(num1, num2)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size()*random_nums2.size());
-  std::cout << "Average time for " << random_nums1.size()*random_nums2.size() << " calls to (2 arg curried function) comp: " << ave_diff << " ns" << std::endl;
-
-
-
-  // runtime performance
-  std::cout << std::endl << "Storing in a std::function" << std::endl;
+  auto eager_comp = make_eager(comp);
+  suite.check("comp", manual_comp(5, 3), comp(5, 3)());
+  suite.check("eager_comp", manual_comp(5, 3), eager_comp(5, 3));
+
+  suite.run("composition/lambda", n2, over2(manual_comp));
+  suite.run("composition/composed", n2, over2([&](int a, int b) {return comp(a, b)();}));
+  suite.run("composition/make_eager", n2, over2(eager_comp));
+#if __cpp_constexpr >= 201603L
+  bool table_matches = true;
+  for (std::size_t i = 0; i < affine_table.size(); ++i)
+    table_matches &= affine_table[i] == ct_affine(static_cast<int>(i))();
+  suite.check("constexpr affine_table", true, table_matches);
+#endif
+
+
+
+  // batch application
+  suite.section("Batch application over contiguous data");
+  std::vector<int> batch1, batch2, batch_out(10000), batch_check(10000);
+  for (auto i = 0; i < 10000; ++i) {
+    batch1.push_back(random_num());
+    batch2.push_back(random_num());
+  }
+  const auto nb = batch1.size();
+  for (std::size_t i = 0; i < nb; ++i) batch_check[i] = _adder(2, batch1[i]);
+  vmap(addtwo, batch1, batch_out);
+  suite.check("vmap", true, batch_out == batch_check);
+  vmap_simd(addtwo, batch1, batch_out);
+  suite.check("vmap_simd", true, batch_out == batch_check);
+  for (std::size_t i = 0; i < nb; ++i) batch_check[i] = _adder(batch1[i], batch2[i]);
+  vzipWith(adder, batch1, batch2, batch_out);
+  suite.check("vzipWith", true, batch_out == batch_check);
+  vzipWith_simd(adder, batch1, batch2, batch_out);
+  suite.check("vzipWith_simd", true, batch_out == batch_check);
+  // (the output may be one of the inputs)
+  auto batch_in_place = batch1;
+  vzipWith(adder, batch_in_place, batch2, batch_in_place);
+  suite.check("vzipWith in place", true, batch_in_place == batch_check);
+  std::vector<int> batch_short(10);
+  bool short_output_rejected = false;
+  try {vmap(addtwo, batch1, batch_short);}
+  catch (const std::length_error&) {short_output_rejected = true;}
+  suite.check("vmap into a short output", true, short_output_rejected);
+
+  auto batch_sink = [&]() {do_not_optimize(batch_out.data()); bench::clobber_memory();};
+  suite.run("batch/map/per_call", nb, [&]() {
+      for (std::size_t i = 0; i < nb; ++i) batch_out[i] = addtwo(batch1[i])();
+      batch_sink();});
+  suite.run("batch/map/vmap", nb, [&]() {vmap(addtwo, batch1, batch_out); batch_sink();});
+  suite.run("batch/map/vmap_simd", nb, [&]() {vmap_simd(addtwo, batch1, batch_out); batch_sink();});
+  suite.run("batch/zip/per_call", nb, [&]() {
+      for (std::size_t i = 0; i < nb; ++i) batch_out[i] = adder(batch1[i], batch2[i])();
+      batch_sink();});
+  suite.run("batch/zip/vzipWith", nb, [&]() {vzipWith(adder, batch1, batch2, batch_out); batch_sink();});
+  suite.run("batch/zip/vzipWith_simd", nb, [&]() {vzipWith_simd(adder, batch1, batch2, batch_out); batch_sink();});
+
+
+
+  // runtime polymorphism
+  suite.section("Storing in a std::function");
   auto re_eager = make_eager(addtwo);
   std::function<int(int)> re = addtwo;
   auto rere = make_curriable(re);
   auto rerere = make_curriable<decltype(addtwo.func)>(re); // i.e. rerere == addtwo
-  // auto rerere = make_curriable(addtwo, re); // i.e. rerere == addtwo
+  auto reref = make_curriable_ref(re); // refers to re instead of copying it
   // re(3,4); // compile-time error
   // re(3)(); // compile-time error
+  suite.check("re", 2+3+3, re(3));
+  suite.check("rere", 2+3+3, rere(3)());
+  suite.check("rerere", 2+3+3, rerere(3)());
+  suite.check("reref", 2+3+3, reref(3)());
+  suite.check("addtwo * reref", 2+2*(2+3+3), (addtwo * reref)(3)());
 
-  std::cout << "Value check: " << 2+3+3 << " == " << re(3) << std::endl;
-
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    loop_sum += re(num1);
-
-  // adding two numbers
-  start = clock();
-  for (auto num1 : random_nums1)
-    loop_sum += 2 + num1 + num1;
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " addition of two numbers: " << ave_diff << " ns" << std::endl;
-
-  // re-eagered function
-  start = clock();
-  for (auto num1 : random_nums1)
-    loop_sum += re_eager(num1);
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " calls to (re-eagered function) re_eager: " << ave_diff << " ns" << std::endl;
-
-  // std::function function
-  start = clock();
-  for (auto num1 : random_nums1)
-    loop_sum += re(num1);
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " calls to (1 arg std::function) re: " << ave_diff << " ns" << std::endl;
-
-  // re-curried function
-  start = clock();
-  for (auto num1 : random_nums1)
-    loop_sum += rere(num1)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " calls to (1 arg re-curried function) rere: " << ave_diff << " ns" << std::endl;
-
-  // re-curried function
-  start = clock();
-  for (auto num1 : random_nums1)
-    loop_sum += rerere(num1)();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " calls to (1 arg re-curried \"type specified\" function) rerere: " << ave_diff << " ns" << std::endl;
-
-
-
-
-  // thunk performance
-  std::cout << std::endl << "Forcing and retrieving a thunk" << std::endl;
-  std::list<std::function<int()>> random_thunks;
-  for (auto num1 : random_nums1)
-    // random_thunks.push_back(static_cast<std::function<int()>>(addtwo(num1))); // requires ugly static_cast
-    random_thunks.emplace_back(addtwo(num1));
-
-  std::cout << "Priming loops ..." << std::endl;
-  for (auto num1 : random_nums1)
-    loop_sum += num1;
-
-  start = clock();
-  for (auto num1 : random_nums1)
-    loop_sum += num1;
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " additions of random numbers: " << ave_diff << " ns" << std::endl;
-
-  std::cout << "Priming thunk loops ..." << std::endl;
-  for (const auto &thunk : random_thunks) // ignore this warning
-    loop_sum += 1;
-
-  start = clock();
-  for (const auto &thunk : random_thunks)
-    loop_sum += thunk();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " calls to force a thunk: " << ave_diff << " ns" << std::endl;
+  suite.run("std_function/inline_addition", n1, over1([](int a) {return 2 + a + a;}));
+  suite.run("std_function/make_eager", n1, over1(re_eager));
+  suite.run("std_function/std_function", n1, over1([&](int a) {return re(a);}));
+  suite.run("std_function/recurried", n1, over1([&](int a) {return rere(a)();}));
+  suite.run("std_function/recurried_type_specified", n1, over1([&](int a) {return rerere(a)();}));
+  suite.run("std_function/function_ref", n1, over1([&](int a) {return reref(a)();}));
 
-  start = clock();
-  for (const auto &thunk : random_thunks)
-    loop_sum += thunk();
-  end = clock();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(random_nums1.size());
-  std::cout << "Average time for " << random_nums1.size() << " calls to retrieve a thunk: " << ave_diff << " ns" << std::endl;
+  // partial application copies the std::function, but not a function_ref
+  std::function<int(int, int)> re2 = make_eager(adder);
+  auto rere2 = make_curriable(re2);
+  auto reref2 = make_curriable_ref(re2);
+  suite.check("rere2", _adder(2, 3), rere2(2)(3)());
+  suite.check("reref2", _adder(2, 3), reref2(2)(3)());
 
+  suite.run("std_function/2args/std_function", n2, over2([&](int a, int b) {return re2(a, b);}));
+  suite.run("std_function/2args/recurried_one_at_a_time", n2, over2([&](int a, int b) {return rere2(a)(b)();}));
+  suite.run("std_function/2args/function_ref_one_at_a_time", n2, over2([&](int a, int b) {return reref2(a)(b)();}));
 
 
 
-  std::cout << "\n\nDummy sum value: " << loop_sum << std::endl;
-  std::cout << "\n\ninfix test: " << 2 %adder% 3 << std::endl;
-  std::cout << "call test: " << adder% 2% 3 << std::endl;
+  // thunk performance
+  suite.section("Forcing and retrieving a thunk");
+  std::vector<std::function<int()>> thunks;
+  auto make_thunks = [&]() {
+    thunks.clear();
+    for (auto a : nums1)
+      thunks.emplace_back(addtwo(a));};
+  auto sum_thunks = [&]() {for (const auto &thunk : thunks) do_not_optimize(thunk());};
+  make_thunks();
+  long long thunk_total = 0, expected_total = 0;
+  for (const auto &thunk : thunks) thunk_total += thunk();
+  for (auto a : nums1) expected_total += _adder(2, a);
+  suite.check("sum of forced thunks", expected_total, thunk_total);
+
+  suite.run("thunk/force", n1, make_thunks, sum_thunks);
+  // thunks are left forced by the previous benchmark
+  suite.run("thunk/retrieve", n1, sum_thunks);
+
+#if defined(FCPP_INSTRUMENT)
+  {
+    make_thunks();
+    instrument::scoped_stats region;
+    sum_thunks();
+    sum_thunks();
+    suite.check("instrumented thunk forces", n1, region.delta()[instrument::thunk_forces]);
+    suite.check("instrumented thunk gets", n1, region.delta()[instrument::thunk_gets]);
+  }
+#endif
+
+#if defined(FCPP_TREADSAFE_SUSP)
+  // retrieve the same (already forced) thunks from several threads at once
+  const std::size_t thread_count = std::max(2u, std::thread::hardware_concurrency());
+  const int concurrent_loops = 100;
+  suite.run("thunk/retrieve_concurrently", n1*concurrent_loops*thread_count, [&]() {
+      std::vector<std::thread> threads;
+      for (std::size_t t = 0; t < thread_count; ++t)
+        threads.emplace_back([&]() {
+            for (auto i = 0; i < concurrent_loops; ++i)
+              for (const auto &thunk : thunks)
+                do_not_optimize(thunk());});
+      for (auto &thread : threads)
+        thread.join();});
+#endif
+
+
+
+  // copying memoized thunks
+  suite.section("Copying a forced thunk");
+  auto forced_thunk = addtrio(2)(3)(4);
+  auto shared_thunk = addtrio(2)(3)(4).share();
+  suite.check("forced_thunk", _addtrio(2,3,4), forced_thunk());
+  suite.check("shared_thunk", _addtrio(2,3,4), shared_thunk());
+
+  suite.run("thunk/copy_forced", n1, over1([&](int a) {auto copy = forced_thunk; return a + copy();}));
+  suite.run("thunk/copy_shared", n1, over1([&](int a) {auto copy = shared_thunk; return a + copy();}));
+
+
+
+  // asynchronous thunks
+  suite.section("Forcing thunks on a thread pool");
+  auto slow_sum = make_curriable<1>([](int n) {long long total = 0; for (int i = 0; i < n; ++i) total += i % 7; return total;});
+  auto slow_sum_check = [](int n) {long long total = 0; for (int i = 0; i < n; ++i) total += i % 7; return total;};
+  suite.check("make_async", slow_sum_check(100000), make_async(slow_sum(100000))());
+
+  suite.run("async/synchronous", n1, over1([&](int a) {return slow_sum(10000 + a)();}));
+  suite.run("async/thread_pool", n1, [&]() {
+      std::vector<decltype(make_async(slow_sum(0)))> sparks;
+      for (auto a : nums1)
+        sparks.push_back(make_async(slow_sum(10000 + a)));
+      for (const auto &spark : sparks)
+        do_not_optimize(spark());});
+
+
+
+  // memoized functoid
+  suite.section("Memoized functoid");
+  auto memo_sum = make_memoized<1>(slow_sum.func);
+  suite.check("memo_sum", slow_sum_check(10000), memo_sum(10000)());
+  suite.check("composed memo_sum", slow_sum_check(10000), (make_curriable<1>([](long long x) {return x;}) * memo_sum)(10000)());
+  // (no shards and no capacity still give one shard holding one result)
+  _impl::memo_table<std::tuple<long long>, long long> degenerate_table(memo_options{0, eviction_policy::lru, 0});
+  suite.check("memo_table capacity with no shards", std::size_t(1), degenerate_table.capacity);
+  suite.check("memo_table shards with no shards", std::size_t(1), degenerate_table.shards.size());
+
+  suite.run("memoize/uncached", n1, over1([&](int a) {return slow_sum(10000 + a)();}));
+  // the warm up run fills the cache
+  suite.run("memoize/cached", n1, over1([&](int a) {return memo_sum(10000 + a)();}));
+
+
+
+  // recursion
+  suite.section("Recursion (fix and trampolined fix)");
+  auto recursive_sum = fix([](auto&& self, unsigned long long n, unsigned long long acc) -> unsigned long long
+      {return n == 0 ? acc : self(self, n - 1, acc*31 + n);});
+  auto trampolined_sum = fix_trampolined<unsigned long long, unsigned long long, unsigned long long>([](auto&& self, unsigned long long n, unsigned long long acc)
+      {return n == 0 ? self.done(acc) : self(n - 1, acc*31 + n);});
+  const unsigned long long depth = 10000;
+  auto loop_check = [](unsigned long long n, unsigned long long acc) {for (; n != 0; --n) acc = acc*31 + n; return acc;};
+  suite.check("recursive_sum", loop_check(depth, 0ULL), recursive_sum(depth, 0ULL));
+  suite.check("trampolined_sum", loop_check(depth, 0ULL), trampolined_sum(depth, 0ULL));
+  const unsigned long long deep = 100000000;
+  suite.check("trampolined_sum 1e8 deep", loop_check(deep, 0ULL), trampolined_sum(deep, 0ULL));
+  // (int arguments are converted to the state types, not the other way round)
+  suite.check("trampolined_sum of int arguments", loop_check(100000, 0ULL), trampolined_sum(100000, 0));
+  auto factorial = fix_trampolined<long double, long double, long double>([](auto&& self, long double n, long double acc)
+      {return n < 2 ? self.done(acc) : self(n - 1, n * acc);});
+  suite.check("trampolined factorial(20, 1)", 2432902008176640000.0L, factorial(20, 1));
+
+  suite.run("recursion/loop", n1*depth, over1([&](int a) {return loop_check(depth, static_cast<unsigned long long>(a));}));
+  suite.run("recursion/fix", n1*depth, over1([&](int a) {return recursive_sum(depth, static_cast<unsigned long long>(a));}));
+  suite.run("recursion/fix_trampolined", n1*depth,
+      over1([&](int a) {return trampolined_sum(depth, static_cast<unsigned long long>(a));}));
+
+
+
+  // infix notation
+  suite.section("Infix notation");
+  suite.check("2 %adder% 3", _adder(2, 3), (2 %adder% 3)());
+  suite.check("adder% 2% 3", _adder(2, 3), (adder% 2% 3)());
 
   // std::function is subtype polymorphic (but eager)!!!
   //  I think for the sake of maximal STL compatibility std::function should take the role of indirect functoids
@@ -409,48 +390,5 @@ int main ()
   // std::function<C*(B*)> base = derived;
   // base = [](A *) {return new D();};
 
-  return 0;
-
-  // // testing const-ness of lambda and arguments (passed!)
-  // auto addeight = addtrio(2, 3);
-  // std::cout << addtrio(2)(3)(4)() << ", " << addtrio(2)(3, 4)() << ", " << addeight(4)() << std::endl;
-  // std::cout << addtrio(2)(3)(4, 5, 'd')() << std::endl;
-
-  // auto add18 = addtrio(_, 3, 4);
-  // auto addduo = addtrio(_, 3);
-  // auto add14 = addtrio(2, _, 4);
-  // std::cout << add18(2)() << ", "<< addduo(2,4)() << std::endl;
-  // std::cout << add14(3)() << std::endl;
-  // int arg = 3;
-  // std::cout << add14(arg)() << std::endl;
-  // const int &arg_ref = arg;
-  // std::cout << add14(arg_ref)() << std::endl;
-  // int &arg_ref2 = arg;
-  // ++arg_ref2;
-  // std::cout << add14(arg_ref2)() << std::endl;
-
-  // // std::cout << "is thunk forced?" << std::endl;
-  // auto addtriothunk = addtrio(2)(3)(4);
-  // std::cout << addtriothunk() << std::endl;
-  // std::cout << addtriothunk() << std::endl;
-  // 
-  // std::function<int()> holder = addtrio(2)(3)(4);
-  // std::cout << holder() << ", " << holder() << std::endl;
-  // holder = addtwo(3);
-  // std::cout << holder() << ", " << holder() << std::endl;
-
-
-  // // std::cout << "is thunk forced?" << std::endl;
-  // auto addtriothunk = addtrio(2)(3)(4);
-  // std::cout << addtriothunk() << std::endl;
-  // std::cout << addtriothunk() << std::endl;
-
-  // const auto& l = [](auto x) {return 2.0*x;};
-  // auto c = make_curriable<1>(l);
-  // std::cout << l(5) << ", " << c(5)() << std::endl;
-
-  // auto factorial = fix([](auto&& self, long double n) -> long double
-  //     { return n < 2.0 ? 1.0 : n * self(self, n - 1.0); });
-
-  // std::cout << factorial(1000) << std::endl;
+  return suite.exit_code();
 }
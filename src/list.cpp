@@ -1,68 +1,440 @@
+#include <algorithm>
 #include <iostream>
-#include <random>
-#include <chrono>
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "FC++14/prelude.h"
+#include "FC++14/allocator.h"
+#include "FC++14/mapped_file.h"
+#if defined(FCPP_TREADSAFE_SUSP)
+#include "FC++14/parallel.h"
+#include "FC++14/reclaim.h"
+#endif
+#include "src/benchmark.h"
 
 
-using namespace std::chrono;
 using namespace fcpp;
+using bench::do_not_optimize;
 
-int main ()
+// space separated elements of a (finite) list
+template <class L>
+std::string show (const L &l)
 {
-  // // random number generation setup
-  // std::random_device rd;
-  // std::mt19937 gen(rd());
-  // std::uniform_int_distribution<> dis(-10, 10);
-  // auto random_num = [&gen, &dis]() {return dis(gen);};
-  // setup clock for timing
-  auto start = steady_clock::now();
-  auto end = steady_clock::now();
-  auto ave_diff = duration <double, std::nano> (end - start).count();
+  std::ostringstream os;
+  for (auto e : l)
+    os << e << "  ";
+  return os.str();
+}
+
+int main (int argc, char **argv)
+{
+  bench::suite suite("Timing comparisons for lazy lists", argc, argv);
 
+  suite.section("List construction and access");
   List<int> l1;
-  std::cout << std::boolalpha << nil(l1)() << std::endl;
+  suite.check("nil(l1)", true, nil(l1)());
   List<int> test(9);
-  std::cout << test.head() << std::endl;
-  std::cout << std::boolalpha << nil(test)() << "\t\t" << (nil * tail(test))() << std::endl;
+  suite.check("test.head()", 9, test.head());
+  suite.check("nil(test)", false, nil(test)());
+  suite.check("(nil * tail)(test)", true, (nil * tail(test))());
   List<int> test2(8, test);
+  suite.check("head(test2)", 8, head(test2)());
   auto l2 = cons(0) * cons(1) * cons(2, l1);
-  std::cout << head(l2)() << std::endl;
-  std::cout << head(tail(l2))() << std::endl;
-  std::cout << head(tail(tail(l2)))() << std::endl;
+  suite.check("head(l2)", 0, head(l2)());
+  suite.check("head(tail(l2))", 1, head(tail(l2))());
+  suite.check("head(tail(tail(l2)))", 2, head(tail(tail(l2)))());
   auto l3 = enumFrom(1,2);
-  std::cout << (head * tail * tail * tail * tail(l3))() << std::endl;
+  suite.check("fifth element of enumFrom(1,2)", 5, (head * tail * tail * tail * tail(l3))());
   auto element10 = head * tail * tail * tail * tail * tail * tail * tail * tail * tail;
-  std::cout << element10(l3)() << std::endl;
+  suite.check("tenth element of enumFrom(1,2)", 10, element10(l3)());
   auto l4 = enumFromTo(1,2,10);
-  std::cout << element10(l4)() << std::endl;
+  suite.check("tenth element of enumFromTo(1,2,10)", 10, element10(l4)());
   // tail * element10(l4); // compile time error
-  for (auto e : l4())
-    std::cout << e << "  ";
-  std::cout << std::endl; 
+  suite.check("enumFromTo(1,2,10)", std::string("1  2  3  4  5  6  7  8  9  10  "), show(l4()));
   auto l5 = enumFromTo('a','b','z');
-  for (auto e : l5())
-    std::cout << e << "  ";
-  std::cout << std::endl; 
-
-
-  double sum = 0.0;
-  long long large_loop = 100000;
-  start = steady_clock::now();
-  for (auto e : enumFromTo(1,2,large_loop)())
-    sum += e;
-  end = steady_clock::now();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(large_loop);
-  std::cout << "Average per-element time for summing enumerated " << large_loop << " numbers: " << ave_diff << " ns" << std::endl;
-
-  start = steady_clock::now();
-  for (long long i = 1; i <= large_loop; ++i)
-    sum += i;
-  end = steady_clock::now();
-  ave_diff = duration <double, std::nano> (end - start).count() / static_cast<decltype(ave_diff)>(large_loop);
-  std::cout << "Average per-element time for summing " << large_loop << " numbers: " << ave_diff << " ns" << std::endl;
-
-  std::cout << std::endl; 
-
-  return 0;
+  suite.check("enumFromTo('a','b','z')", std::string("a  b  c  d  e  f  g  h  i  j  k  l  m  n  o  p  q  r  s  t  u  v  w  x  y  z  "),
+      show(l5()));
+  // consing onto the middle of a chunk
+  suite.check("cons(0, tail(tail(enumFromTo(1,2,5))))", std::string("0  3  4  5  "), show(cons(0, tail(tail(enumFromTo(1,2,5))))()));
+  // narrow types end at their last element instead of wrapping around past it
+  auto show_ints = [](const auto &l) {std::string s; for (auto e : l) s += std::to_string(int(e)) + "  "; return s;};
+  suite.check("enumFromTo(250,251,255) of unsigned char", std::string("250  251  252  253  254  255  "),
+      show_ints(enumFromTo((unsigned char)250,(unsigned char)251,(unsigned char)255)()));
+  suite.check("enumFromTo(120,121,127) of signed char", std::string("120  121  122  123  124  125  126  127  "),
+      show_ints(enumFromTo((signed char)120,(signed char)121,(signed char)127)()));
+  suite.check("enumFromTo(32760,32762,32767) of short", std::string("32760  32762  32764  32766  "),
+      show_ints(enumFromTo((short)32760,(short)32762,(short)32767)()));
+
+
+
+  suite.section("Traversal");
+  const long long large_loop = 100000;
+  long long expected_sum = large_loop*(large_loop + 1)/2, list_sum = 0;
+  for (auto e : enumFromTo(1LL,2LL,large_loop)())
+    list_sum += e;
+  suite.check("sum of enumFromTo(1,2,100000)", expected_sum, list_sum);
+
+  suite.run("list/loop_sum", large_loop, [&]() {for (long long i = 1; i <= large_loop; ++i) do_not_optimize(i);});
+  // builds the list while walking it
+  suite.run("list/enumFromTo_sum", large_loop, [&]() {for (auto e : enumFromTo(1LL,2LL,large_loop)()) do_not_optimize(e);});
+  // walks an already built (and forced) list
+  auto built = enumFromTo(1LL,2LL,large_loop)();
+  for (auto e : built) do_not_optimize(e);
+  suite.run("list/traverse_forced", large_loop, [&built]() {for (auto e : built) do_not_optimize(e);});
+
+#if defined(FCPP_INSTRUMENT)
+  {
+    instrument::scoped_stats first_walk;
+    auto counted = enumFromTo(1,2,1000)();
+    for (auto e : counted) do_not_optimize(e);
+    // one node (and one generated tail) per chunk
+    const std::uint64_t chunks = (1000 + _impl::list_chunk_size - 1)/_impl::list_chunk_size;
+    suite.check("instrumented list nodes", chunks, first_walk.delta()[instrument::list_nodes]);
+    suite.check("instrumented generated tails", chunks, first_walk.delta()[instrument::list_tails_generated]);
+    instrument::scoped_stats second_walk;
+    for (auto e : counted) do_not_optimize(e);
+    suite.check("instrumented reused tails", chunks - 1, second_walk.delta()[instrument::list_tails_reused]);
+  }
+#endif
+
+
+
+  suite.section("Fused list functions");
+  auto odd = [](long long x) {return x % 2 != 0;};
+  auto square = [](long long x) {return x*x;};
+  auto plus = [](long long a, long long b) {return a + b;};
+  auto sum_odd_squares = foldl(plus, 0LL) * map(square) * filter(odd) * enumFromTo(1LL,2LL,large_loop);
+  long long loop_odd_squares = 0;
+  for (long long i = 1; i <= large_loop; ++i) if (odd(i)) loop_odd_squares += square(i);
+  suite.check("foldl(+, 0) * map(square) * filter(odd) * enumFromTo", loop_odd_squares, sum_odd_squares());
+  suite.check("map and filter of a List", std::string("1  9  25  49  81  "), show(map(square, filter(odd, l4()))()));
+  suite.check("take 3 of drop 2 of enumFrom(1,2)", std::string("3  4  5  "), show((take(3) * drop(2) * enumFrom(1,2))()));
+  suite.check("zipWith(+) of a List and a stream", std::string("3  5  7  "), show(zipWith(plus, enumFromTo(1,2,3), take(3, enumFrom(2,3)))()));
+  List<long long> fused_list = (map(square) * enumFromTo(1LL,2LL,5LL))();
+  suite.check("stream converted to a List", std::string("1  4  9  16  25  "), show(fused_list));
+  suite.check("enumFromTo(5,6,1) keeps its first element", std::string("5  "), show(enumFromTo(5,6,1)()));
+  // (the fused loop ends at the last element of a narrow type, as the List does)
+  suite.check("foldl(+, 0) * enumFromTo(250,251,255) of unsigned char", 1515LL,
+      (foldl(plus, 0LL) * enumFromTo((unsigned char)250,(unsigned char)251,(unsigned char)255))());
+  suite.check("foldl(+, 0) * map(square) * enumFromTo(120,121,127) of signed char", 122060LL,
+      (foldl(plus, 0LL) * map(square) * enumFromTo((signed char)120,(signed char)121,(signed char)127))());
+  suite.check("foldl(+, 0) * enumFromTo(-120,-124,127) of signed char (down to -128)", -372LL,
+      (foldl(plus, 0LL) * enumFromTo((signed char)-120,(signed char)-124,(signed char)127))());
+
+  suite.run("list/sum_odd_squares/loop", large_loop, [&]() {
+      long long total = 0;
+      for (long long i = 1; i <= large_loop; ++i) if (odd(i)) total += square(i);
+      do_not_optimize(total);});
+  suite.run("list/sum_odd_squares/fused", large_loop, [&]() {
+      do_not_optimize((foldl(plus, 0LL) * map(square) * filter(odd) * enumFromTo(1LL,2LL,large_loop))());});
+  suite.run("list/sum_odd_squares/forced_list", large_loop, [&]() {
+      do_not_optimize(foldl(plus, 0LL, map(square, filter(odd, built))())());});
+#if defined(FCPP_INSTRUMENT)
+  {
+    instrument::scoped_stats fused;
+    do_not_optimize((foldl(plus, 0LL) * map(square) * filter(odd) * enumFromTo(1LL,2LL,large_loop))());
+    suite.check("instrumented list nodes (fused)", std::uint64_t(0), fused.delta()[instrument::list_nodes]);
+  }
+#endif
+
+
+
+  suite.section("Streaming traversal");
+  {
+    // (the head is held throughout, yet nothing behind the cursor is kept)
+    const long long stream_count = 10000000;
+    auto naturals = enumFrom(1LL,2LL)();
+    suite.check("sum of 10M streamed elements of a held enumFrom(1,2)", stream_count*(stream_count + 1)/2,
+        foldl(plus, 0LL, take(stream_count, naturals.stream()))());
+    long long streamed_sum = 0;
+    for (auto e : enumFromTo(1LL,2LL,large_loop)().stream()) streamed_sum += e;
+    suite.check("sum of a streamed enumFromTo(1,2,100000)", expected_sum, streamed_sum);
+    suite.run("list/stream/enumFromTo_sum", large_loop, [&]() {for (auto e : enumFromTo(1LL,2LL,large_loop)().stream()) do_not_optimize(e);});
+    suite.run("list/stream/traverse_forced", large_loop, [&built]() {for (auto e : built.stream()) do_not_optimize(e);});
+#if defined(FCPP_INSTRUMENT)
+    auto unshared = enumFromTo(1,2,1000)();
+    for (auto e : unshared.stream()) do_not_optimize(e);
+    instrument::scoped_stats after_stream;
+    for (auto e : unshared) do_not_optimize(e);
+    // (the streamed pass left no tail behind)
+    const std::uint64_t chunks = (1000 + _impl::list_chunk_size - 1)/_impl::list_chunk_size;
+    suite.check("instrumented generated tails after streaming", chunks, after_stream.delta()[instrument::list_tails_generated]);
+#endif
+  }
+
+
+
+  suite.section("Views over contiguous data");
+  {
+    auto numbers = std::make_shared<std::vector<long long>>(large_loop);
+    for (long long i = 0; i < large_loop; ++i) (*numbers)[i] = i + 1;
+    const long long *data = numbers->data();
+    auto shared_view = make_list_view(numbers);
+    auto borrowed_view = borrow_list_view(*numbers);
+    suite.check("view head refers to the buffer", true, &shared_view.head() == data);
+    auto third = borrowed_view.tail().tail();
+    suite.check("view tail refers to the buffer", true, &third.head() == data + 2);
+    long long view_sum = 0;
+    for (auto e : borrowed_view) view_sum += e;
+    suite.check("sum of a borrowed view", expected_sum, view_sum);
+    suite.check("foldl(+, 0) over a shared view", expected_sum, foldl(plus, 0LL, shared_view)());
+    auto rest = tail(tail(shared_view))();
+    borrowed_view = List<long long>();
+    shared_view = List<long long>();
+    numbers.reset();
+    suite.check("view keeps its buffer alive", 3LL, rest.head());
+    const std::vector<int> no_numbers;
+    suite.check("view of an empty buffer", false, borrow_list_view(no_numbers).is_empty());
+
+    std::vector<long long> values(large_loop);
+    for (long long i = 0; i < large_loop; ++i) values[i] = i + 1;
+    auto copied_list = [&values]() {
+      List<long long> l;
+      for (auto it = values.rbegin(); it != values.rend(); ++it) l = List<long long>(*it, l);
+      return l;};
+    suite.run("list/contiguous/copy_then_traverse", large_loop, [&]() {for (auto e : copied_list()) do_not_optimize(e);});
+    suite.run("list/contiguous/view_traverse", large_loop, [&]() {for (auto e : borrow_list_view(values)) do_not_optimize(e);});
+#if defined(FCPP_INSTRUMENT)
+    instrument::scoped_stats view_walk;
+    for (auto e : borrow_list_view(values)) do_not_optimize(e);
+    suite.check("instrumented list nodes (view)", std::uint64_t(1), view_walk.delta()[instrument::list_nodes]);
+#endif
+  }
+
+
+
+  suite.section("Mapped files");
+  {
+    const std::string lines_path = std::filesystem::temp_directory_path()/"fcpp_list_lines.txt";
+    const std::string records_path = std::filesystem::temp_directory_path()/"fcpp_list_records.bin";
+    const long long line_count = large_loop;
+    {
+      std::ofstream lines_out(lines_path);
+      for (long long i = 1; i <= line_count; ++i) lines_out << "line " << i << (i < line_count ? "\n" : "");
+      std::ofstream records_out(records_path, std::ios::binary);
+      for (long long i = 1; i <= large_loop; ++i) records_out.write(reinterpret_cast<const char*>(&i), sizeof(i));
+      records_out.write("xyz", 3);  // (a trailing partial record)
+    }
+    auto lines_file = std::make_shared<const mapped_file>(lines_path);
+    auto lines = mapped_lines(lines_file);
+    suite.check("first mapped line", std::string("line 1"), std::string(lines.head()));
+    suite.check("first mapped line points into the file", true, lines.head().data() == lines_file->data());
+    long long mapped_line_count = 0;
+    std::string_view last_line;
+    for (auto line : lines.stream()) {++mapped_line_count; last_line = line;}
+    suite.check("number of mapped lines", line_count, mapped_line_count);
+    suite.check("last mapped line (without a newline)", std::string("line 100000"), std::string(last_line));
+    // (the list alone keeps the file mapped, down to its last chunk)
+    long long unheld_line_count = 0;
+    std::string unheld_last_line;
+    for (auto line : mapped_lines(lines_path).stream()) {++unheld_line_count; unheld_last_line = line;}
+    suite.check("number of lines of a file only the list holds", line_count, unheld_line_count);
+    suite.check("last line of a file only the list holds", std::string("line 100000"), unheld_last_line);
+    const std::string short_path = std::filesystem::temp_directory_path()/"fcpp_list_short.txt";
+    {std::ofstream short_out(short_path); short_out << "a\nbb\nccc\n";}
+    auto short_file = std::make_shared<const mapped_file>(short_path);
+    std::weak_ptr<const mapped_file> short_watch = short_file;
+    auto short_lines = mapped_lines(std::move(short_file));
+    suite.check("a list shorter than a chunk keeps its file mapped", false, short_watch.expired());
+    suite.check("lines of a file only the list holds", std::string("a  bb  ccc  "), show(mapped_lines(short_path)));
+    std::remove(short_path.c_str());
+
+    auto records_file = std::make_shared<const mapped_file>(records_path);
+    auto records = mapped_records<long long>(records_file);
+    suite.check("first mapped record points into the file", true,
+        static_cast<const void*>(&records.head()) == static_cast<const void*>(records_file->data()));
+    suite.check("sum of mapped records", expected_sum, foldl(plus, 0LL, records)());
+
+    suite.run("list/mapped/lines", line_count, [&]() {for (auto line : mapped_lines(lines_file).stream()) do_not_optimize(line.size());});
+    suite.run("list/mapped/records", large_loop, [&]() {for (auto e : mapped_records<long long>(records_file)) do_not_optimize(e);});
+    std::remove(lines_path.c_str());
+    std::remove(records_path.c_str());
+  }
+
+
+
+  suite.section("Element access by reference");
+  const long string_count = 1000;
+  List<std::string> strings;
+  for (long i = 0; i < string_count; ++i) strings = List<std::string>(std::string(64, 'a' + i % 26), strings);
+  suite.check("head() refers to the stored element", true, &strings.head() == &strings.head());
+  suite.check("operator-> reaches the element", std::size_t(64), strings.begin()->size());
+  List<std::string> lazy_string([]() {return std::string(64, 'z');});
+  suite.check("head() refers to the memoized element", true, &lazy_string.head() == &lazy_string.head());
+  // (the thunk's int is converted to a long before it is memoized)
+  suite.check("converted thunk result", 7L, List<long>([]() {return 7;}).head());
+  suite.run("list/strings/by_reference", string_count, [&]() {for (const auto &e : strings) do_not_optimize(e.size());});
+  suite.run("list/strings/by_value", string_count, [&]() {for (auto e : strings) do_not_optimize(e.size());});
+
+
+
+  suite.section("Node allocation (build and release)");
+  const long node_count = 10000;
+  auto build_and_release = [node_count](auto alloc) {
+    using list_t = List<long, decltype(alloc)>;
+    list_t l;
+    for (long i = 0; i < node_count; ++i) l = list_t(i, l, alloc);
+    do_not_optimize(l.head());};
+  suite.run("list/alloc/std_allocator", node_count, [&]() {build_and_release(std::allocator<long>());});
+  suite.run("list/alloc/pool_allocator", node_count, [&]() {build_and_release(pool_allocator<long>());});
+  {
+    // (blocks freed on another thread go back to the pool that carved them,
+    //  so allocating as many again reuses them instead of carving new slabs)
+    struct pooled_record {char bytes[200];};
+    pool_allocator<pooled_record> pool;
+    std::vector<pooled_record*> first, second;
+    for (long i = 0; i < node_count; ++i) first.push_back(pool.allocate(1));
+    std::thread([&]() {for (auto p : first) pool.deallocate(p, 1);}).join();
+    for (long i = 0; i < node_count; ++i) second.push_back(pool.allocate(1));
+    std::sort(first.begin(), first.end());
+    long reused = 0;
+    for (auto p : second) reused += std::binary_search(first.begin(), first.end(), p);
+    suite.check("pool blocks freed on another thread are reused", true,
+        reused + long(_impl::node_pool<pool_allocator<pooled_record>::block_size>::blocks_per_slab) >= node_count);
+    for (auto p : second) pool.deallocate(p, 1);
+  }
+  {
+    monotonic_arena arena;
+    suite.run("list/alloc/arena_allocator", node_count, [&]() {
+        build_and_release(arena_allocator<long>(arena));
+        arena.release();});
+  }
+  {
+    monotonic_arena arena;
+    long arena_sum = 0;
+    for (auto e : enumFromTo(1L,2L,1000L)()) arena_sum += e;
+    for (auto e : make_chunked_list<long>([n = 1L](long *out, std::size_t k) mutable
+        {std::size_t i = 0; for (; i < k && n <= 1000; ++i) out[i] = n++; return i;}, arena_allocator<long>(arena)))
+      arena_sum -= e;
+    suite.check("chunked list in an arena", 0L, arena_sum);
+  }
+  {
+    bool no_arena_rejected = false;
+    try {arena_allocator<long> unbound;}
+    catch (const std::logic_error&) {no_arena_rejected = true;}
+    suite.check("arena_allocator without an arena", true, no_arena_rejected);
+    // (an empty list keeps its allocator, so consing onto it allocates in
+    //  its arena rather than in the current one)
+    using arena_list = List<long, arena_allocator<long>>;
+    monotonic_arena outer;
+    arena_list empty(arena_allocator<long>{outer});
+    monotonic_arena inner;
+    auto consed = cons(1L, empty)();
+    suite.check("empty arena list keeps its arena", true, empty.get_allocator().arena == &outer);
+    suite.check("cons onto an empty arena list", true, outer.bytes_allocated() > 0 && inner.bytes_allocated() == 0);
+    suite.check("tail of an arena list keeps its arena", true, consed.tail().get_allocator().arena == &outer);
+  }
+
+
+
+  suite.section("Releasing long lists");
+  {
+    // (each of these used to overflow the stack when released)
+    auto long_cons = [](long n) {List<long> l; for (long i = 0; i < n; ++i) l = List<long>(i, l); return l;};
+    auto dropped = long_cons(1000000);
+    dropped = List<long>();
+    auto forced = enumFromTo(1L,2L,10000000L)();
+    long last = 0;
+    for (auto e : forced) last = e;
+    forced = List<long>();
+    suite.check("released a forced 10M element list", 10000000L, last);
+
+    const long release_count = 100000;
+    List<long> to_release;
+    auto fresh = [&]() {to_release = long_cons(release_count);};
+    suite.run("list/release/inline", release_count, fresh, [&]() {to_release = List<long>();});
+#if defined(FCPP_TREADSAFE_SUSP)
+    // (only the time the releasing thread spends; the lists are released
+    //  untimed by drain)
+    list_reclaimer reclaimer(false);
+    suite.run("list/release/deferred", release_count, [&]() {reclaimer.drain(); fresh();},
+        [&]() {reclaimer.defer(std::move(to_release));});
+    reclaimer.drain();
+    reclaimer.defer(long_cons(1000));
+    suite.check("deferred list queued", std::size_t(1), reclaimer.pending());
+    reclaimer.drain();
+    // (released on the helper thread of the default reclaimer)
+    release_later(long_cons(1000000));
+#endif
+  }
+
+
+
+#if defined(FCPP_TREADSAFE_SUSP)
+  suite.section("List of expensive thunks");
+  const long long slow_count = 1000;
+  auto slow_element = [](long long n) {return [n]() {long long total = 0; for (long long i = 0; i < n; ++i) total += i % 7; return total;};};
+  auto slow_list = [&slow_element, slow_count]() {
+    List<long long> l;
+    for (long long i = 0; i < slow_count; ++i) l = List<long long>(slow_element(10000 + i), l);
+    return l;};
+  long long slow_sum = 0, par_sum = 0;
+  for (auto e : slow_list()) slow_sum += e;
+  for (auto e : parBuffer(16, slow_list())()) par_sum += e;
+  suite.check("parBuffer 16 sum", slow_sum, par_sum);
+  auto mirrored = slow_list();
+  suite.check("unforced element is pending", true, mirrored._head->is_pending());
+  auto mirror = parBuffer(4, mirrored)();
+  suite.check("parBuffer mirrors elements by reference", true, &mirror.head() == &mirrored.head());
+  suite.check("forced element is not pending", false, mirrored._head->is_pending());
+  suite.check("value element is not pending", false, List<long long>(1LL)._head->is_pending());
+
+  // every repetition gets a fresh (unforced) list
+  List<long long> slow;
+  auto fresh = [&]() {slow = slow_list();};
+  suite.run("list/expensive/sequential", slow_count, fresh, [&]() {for (auto e : slow) do_not_optimize(e);});
+  suite.run("list/expensive/parList", slow_count, fresh, [&]() {for (auto e : parList(slow)()) do_not_optimize(e);});
+  suite.run("list/expensive/parBuffer_16", slow_count, fresh, [&]() {for (auto e : parBuffer(16, slow)()) do_not_optimize(e);});
+#endif
+
+
+
+  suite.section("Reference counting (with other threads running)");
+  // one node per element, so every step copies a node reference
+  auto cons_list = [large_loop](auto empty) {
+    auto l = empty;
+    for (long long i = large_loop; i > 0; --i) l = decltype(empty)(i, l);
+    return l;};
+  auto atomic_list = cons_list(List<long long, std::allocator<long long>, atomic_refcount>());
+  auto local_list = cons_list(List<long long, std::allocator<long long>, local_refcount>());
+  long long atomic_sum = 0, local_sum = 0;
+  for (auto e : atomic_list) atomic_sum += e;
+  for (auto e : local_list) local_sum += e;
+  suite.check("sum of a cons list (atomic_refcount)", expected_sum, atomic_sum);
+  suite.check("sum of a cons list (local_refcount)", expected_sum, local_sum);
+  suite.run("list/traverse_cons/atomic_refcount", large_loop, [&]() {for (auto e : atomic_list) do_not_optimize(e);});
+  suite.run("list/traverse_cons/local_refcount", large_loop, [&]() {for (auto e : local_list) do_not_optimize(e);});
+
+
+#if defined(FCPP_TREADSAFE_SUSP)
+  suite.section("Shared traversal");
+  // threads racing to generate the same tails (the first one published wins)
+  const long shared_count = 100000;
+  const int walkers = 4;
+  std::function<List<long>(long)> naturals = [&naturals](long n) {
+    return List<long>(n, List<long>::list_generator_type([&naturals, n](const List<long>&)
+        {return n < shared_count ? naturals(n + 1) : List<long>();}));};
+  auto walk_together = [walkers](const List<long> &shared) {
+    std::vector<long> sums(walkers, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < walkers; ++t)
+      threads.emplace_back([&shared, &sums, t]() {for (const auto &e : shared) sums[t] += e;});
+    for (auto &thread : threads) thread.join();
+    bool agree = true;
+    for (auto sum : sums) agree &= (sum == shared_count*(shared_count + 1)/2);
+    return agree;};
+  suite.check("threads walking one generated list agree", true, walk_together(naturals(1)));
+  suite.check("threads walking one chunked list agree", true, walk_together(enumFromTo(1L,2L,shared_count)()));
+#endif
+
+  return suite.exit_code();
 }